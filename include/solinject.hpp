@@ -24,7 +24,19 @@
  *
  * This header file provides the following classes:
  * - @ref sol::di::Container
+ * - @ref sol::di::BasicContainer
  * - @ref sol::di::ContainerBuilder
+ * - @ref sol::di::BasicContainerBuilder
+ * - @ref sol::di::Inject
+ * - @ref sol::di::ResolutionContext
+ * - @ref sol::di::BasicResolutionContext
+ * - @ref sol::di::StaticContainer
+ * - @ref sol::di::BasicStaticContainer
+ * - @ref sol::di::ScopePool
+ * - @ref sol::di::BasicScopePool
+ * - @ref sol::di::ServiceHandle
+ * - @ref sol::di::ServicesView
+ * - @ref sol::di::StartupProfile
  * - @ref sol::di::Configuration
  * - @ref sol::di::ConfigurationParser
  *
@@ -32,11 +44,19 @@
  * - @ref sol::di::exc::DIException
  * - @ref sol::di::exc::CircularDependencyException
  * - @ref sol::di::exc::ServiceNotRegisteredException
+ * - @ref sol::di::exc::ContainerFrozenException
+ * - @ref sol::di::exc::ContainerNotFrozenException
+ * - @ref sol::di::exc::ServiceNotBorrowableException
  */
 
 #pragma once
 
 #include "solinject/Container.hpp"
+#include "solinject/ScopePool.hpp"
+#include "solinject/ResolutionContext.hpp"
+#include "solinject/ServiceHandle.hpp"
+#include "solinject/ServicesView.hpp"
+#include "solinject/StaticContainer.hpp"
 #include "solinject/Configuration.hpp"
 #include "solinject/ConfigurationParser.hpp"
 #include "solinject/ContainerBuilder.hpp"
@@ -22,19 +22,10 @@
 
 #pragma once
 #include <string>
+#include "ServiceLifetime.hpp"
 
 namespace sol::di
 {
-    /// @brief Service lifetime
-    enum class ServiceLifetime
-    {
-        Singleton = 0, //< Singleton service lifetime
-        Transient, //< Transient service lifetime
-        Shared, //< Shared service lifetime
-        Scoped, //< Scoped service lifetime
-        None //< No lifetime. Only valid for interface-to-interface registration.
-    };
-
     /// @brief DI configuration item
     class ConfigurationItem
     {
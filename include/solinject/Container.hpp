@@ -22,104 +22,207 @@
 
 #pragma once
 
-#include <map>
 #include <vector>
 #include <algorithm>
 #include <memory>
 #include <typeinfo>
 #include <typeindex>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <memory_resource>
+#include <thread>
+#include <functional>
+#include <future>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <tuple>
 
 #include "Defines.hpp"
+#include "TypeId.hpp"
 #include "IService.hpp"
 #include "IServiceTyped.hpp"
+#include "Factory.hpp"
+#include "ExpandedArgs.hpp"
+#include "Inject.hpp"
+#include "ServiceWarmUp.hpp"
+#include "StartupProfile.hpp"
+#include "StartupRecorder.hpp"
 #include "RegisteredServices.hpp"
 #include "ScopedServiceBuilders.hpp"
+#include "ScopeThreading.hpp"
+#include "ThreadingPolicy.hpp"
+#include "ResolutionCache.hpp"
 #include "Utils.hpp"
+#include "exceptions/ContainerFrozenException.hpp"
+#include "exceptions/ContainerNotFrozenException.hpp"
 
 namespace sol::di
 {
-    namespace impl { class IService; }
+    template <class TThreadingPolicy>
+    class BasicScopePool;
+
+    template <class T, class TThreadingPolicy>
+    class ServiceHandle;
+
+    template <class T, class TThreadingPolicy>
+    class ServicesView;
+
+    template <class TThreadingPolicy>
+    class BasicResolutionContext;
 
     /**
-     * @brief Dependency Injection container
+     * @brief Dependency Injection container with a threading policy
+     *
+     * The threading policy tells how the container guards its state.
+     * The container's scopes and DI services use the same policy, so
+     * nothing is locked at runtime, unless the policy needs it.
+     * Containers with different policies are different types,
+     * which may be used in the same program.
+     *
+     * The following policies are available:
+     * - @ref ExclusiveMutexPolicy
+     * - @ref RecursiveMutexPolicy
+     * - @ref SharedMutexPolicy
+     * - @ref LockFreeFrozenPolicy
+     * - @ref NoThreadingPolicy
+     *
+     * @tparam TThreadingPolicy the threading policy
+     * @see Container
      * @headerfile Container.hpp solinject.hpp
      */
-    class Container
+    template <class TThreadingPolicy>
+    class BasicContainer
     {
     public:
+        /// Threading policy of the container
+        using ThreadingPolicy = TThreadingPolicy;
+
+        /// Context of a service resolution from the container
+        using ResolutionContext = BasicResolutionContext<TThreadingPolicy>;
+
         /**
-         * @copydoc impl::IServiceTyped<T>::Factory
+         * @copydoc impl::IServiceTyped::Factory
          * @tparam T the service type
          */
         template <class T>
-        using Factory = typename impl::IServiceTyped<T>::Factory;
+        using Factory = typename impl::IServiceTyped<TThreadingPolicy, T>::Factory;
 
         /**
-         * @copydoc impl::IServiceTyped<T>::ServicePtr
+         * @copydoc impl::IServiceTyped::ServicePtr
          * @tparam T service type
          */
         template <class T>
-        using ServicePtr = typename impl::IServiceTyped<T>::ServicePtr;
+        using ServicePtr = typename impl::IServiceTyped<TThreadingPolicy, T>::ServicePtr;
 
         /// @copydoc impl::RegisteredServices::DIServicePtr
-        using DIServicePtr = impl::RegisteredServices::DIServicePtr;
+        using DIServicePtr = typename impl::RegisteredServices<TThreadingPolicy>::DIServicePtr;
 
         /// @copydoc impl::ScopedServiceBuilders::ScopedServiceBuilderPtr
-        using ScopedServiceBuilderPtr = impl::ScopedServiceBuilders::ScopedServiceBuilderPtr;
+        using ScopedServiceBuilderPtr = typename impl::ScopedServiceBuilders<TThreadingPolicy>::ScopedServiceBuilderPtr;
 
         /// Default constructor
-        Container() : m_Mutex(std::make_shared<Mutex>()) {}
+        BasicContainer() :
+            m_RegisteredServices(std::make_shared<RegisteredServices>()),
+            m_ScopedServiceBuilders(std::make_shared<ScopedServiceBuilders>()),
+            m_StartupRecorder(std::make_shared<impl::StartupRecorder>())
+        {
+        }
 
         /// Copy constructor (deleted)
-        Container(const Container& other) = delete;
+        BasicContainer(const BasicContainer& other) = delete;
 
         /// Move constructor
-        Container(Container&& other) noexcept : Container()
+        BasicContainer(BasicContainer&& other) noexcept : BasicContainer()
         {
             swap(*this, other);
         }
 
         /// Copy-assignment operator (deleted)
-        Container& operator=(const Container& other) = delete;
+        BasicContainer& operator=(const BasicContainer& other) = delete;
 
         /// Move-assignment operator
-        Container& operator=(Container&& other) noexcept
+        BasicContainer& operator=(BasicContainer&& other) noexcept
         {
             swap(*this, other);
             return *this;
         }
 
-        /// Swaps two @ref Container instances
-        friend void swap(Container& a, Container& b) noexcept
+        /// Swaps two @ref BasicContainer instances
+        friend void swap(BasicContainer& a, BasicContainer& b) noexcept
         {
-            using std::swap;
-
             if (&a == &b)
                 return;
 
-            ScopedLock lock(*a.m_Mutex, *b.m_Mutex);
+            if constexpr (HasMutex)
+            {
+                if (a.m_IsThreadSafe && b.m_IsThreadSafe)
+                {
+                    ScopedLock lock(a.m_Mutex, b.m_Mutex);
+                    SwapUnlocked(a, b);
+                    return;
+                }
+            }
 
-            swap(a.m_RegisteredServices, b.m_RegisteredServices);
-            swap(a.m_ScopedServiceBuilders, b.m_ScopedServiceBuilders);
-            swap(a.m_Mutex, b.m_Mutex);
+            // Single-threaded scopes don't lock their mutex,
+            // so at most one of the locks owns a mutex
+            auto lockA = a.LockMutex();
+            auto lockB = b.LockMutex();
+            SwapUnlocked(a, b);
         }
 
         /**
          * @brief Creates a scoped container
          * from the current container
-         * @returns Scoped @ref Container instance
+         *
+         * The scope doesn't copy the current container's services.
+         * It refers to an immutable snapshot of them instead, so services,
+         * registered in the current container after the scope is created,
+         * are not resolvable from the scope.
+         *
+         * Scoped services are not created with the scope. The scope
+         * reserves an empty slot for each of them and fills it when
+         * the service is resolved from the scope for the first time.
+         *
+         * The scope owns a memory arena (see @ref GetMemoryResource()).
+         *
+         * The scope has its own mutex, so using it doesn't block the current
+         * container and the other scopes. A scope, which is used by one thread
+         * at a time, may be created with @ref ScopeThreading::SingleThreaded,
+         * so it doesn't lock its own state at all. Services, registered in
+         * the parent containers, are resolved thread-safely in both modes.
+         *
+         * @param threading threading mode of the scope
+         * @returns Scoped @ref BasicContainer instance
          */
-        Container CreateScope() const
+        BasicContainer CreateScope(ScopeThreading threading = ScopeThreading::MultiThreaded) const
         {
-            using namespace impl;
+            bool isThreadSafe = threading == ScopeThreading::MultiThreaded && TThreadingPolicy::IsThreadSafe;
+
+            auto lock = LockMutexUnlessFrozen();
+
+            typename RegisteredServices::ScopedServiceSlotsPtr scopedSlots;
 
-            auto lock = LockMutex();
+            if (!m_ScopedServiceBuilders->IsEmpty())
+                scopedSlots = std::make_shared<ScopedServiceSlots>(
+                    typename ScopedServiceBuilders::ConstPtr(m_ScopedServiceBuilders),
+                    isThreadSafe
+                );
 
-            RegisteredServices diServices = m_RegisteredServices;
-            diServices.Merge(m_ScopedServiceBuilders.BuildDIServices());
+            RegisteredServices diServices(
+                RegisteredServicesConstPtr(m_RegisteredServices),
+                std::move(scopedSlots),
+                std::make_shared<ScopeArena>(isThreadSafe)
+            );
 
-            return Container(std::move(diServices), m_Mutex);
+            BasicContainer scope(std::move(diServices), isThreadSafe, m_StartupRecorder);
+
+            scope.m_ParentGeneration = GetRegistrationGeneration();
+            scope.m_IsResolutionCacheEnabled.store(IsResolutionCacheEnabled(), std::memory_order_relaxed);
+
+            return scope;
         }
 
         /**
@@ -130,16 +233,270 @@ namespace sol::di
          */
         bool IsScope() { return m_IsScope; }
 
+        /**
+         * @brief Gets the memory resource for service instances
+         *
+         * A scope allocates from its own memory arena. Deallocation
+         * from the arena is a no-op, and all the arena's memory is
+         * released in bulk when the scope is destroyed. Other
+         * containers use the default memory resource.
+         *
+         * @returns pointer to the memory resource
+         * @see AllocateShared()
+         */
+        std::pmr::memory_resource* GetMemoryResource() const
+        {
+            if (m_Arena != nullptr)
+                return m_Arena;
+
+            return std::pmr::get_default_resource();
+        }
+
+        /**
+         * @brief Creates an instance of a service using
+         * the container's memory resource
+         *
+         * This method is intended for use in factory functions.
+         *
+         * @warning If the container is a scope, the instance must
+         * not outlive the scope. Don't use this method for services,
+         * which may be injected into singleton or shared services.
+         *
+         * Arguments, produced by the @ref FROM_DI_ALL macro,
+         * are expanded into separate constructor arguments.
+         *
+         * @tparam T service type
+         * @tparam TArgs constructor arguments types
+         * @param args constructor arguments
+         * @returns pointer to the created instance
+         * @see GetMemoryResource()
+         */
+        template <class T, class...TArgs>
+        std::shared_ptr<T> AllocateShared(TArgs&&...args) const
+        {
+            return std::apply(
+                [this](auto&&...expandedArgs)
+                {
+                    return std::allocate_shared<T>(
+                        std::pmr::polymorphic_allocator<T>(GetMemoryResource()),
+                        std::forward<decltype(expandedArgs)>(expandedArgs)...
+                    );
+                },
+                std::tuple_cat(impl::AsArgsTuple(std::forward<TArgs>(args))...)
+            );
+        }
+
+        /**
+         * @brief Freezes the container
+         *
+         * A frozen container is immutable: registering a service
+         * in it throws @ref sol::di::exc::ContainerFrozenException.
+         * In exchange, resolving services from a frozen container
+         * doesn't lock the container's mutex.
+         *
+         * Scopes, created from a frozen container, are not frozen.
+         *
+         * Services, registered with @ref Inject, compile their
+         * resolution plans, so resolving them from a frozen
+         * container doesn't search the registered services.
+         *
+         * @throws sol::di::exc::ContainerNotFrozenException
+         */
+        void Freeze()
+        {
+            {
+                auto lock = LockMutex();
+                ThrowIfNotOwned();
+                m_IsFrozen.store(true, std::memory_order_release);
+            }
+
+            m_RegisteredServices->ForEachRegisteredService([this](const RegisteredService& diService)
+            {
+                diService.DIService()->CompilePlan(*this);
+            });
+        }
+
+        /**
+         * @brief Tells if the container is frozen
+         * @returns `true` if the container is frozen, `false` otherwise
+         * @see Freeze()
+         */
+        bool IsFrozen() const
+        {
+            return m_IsFrozen.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Enables or disables the thread-local resolution cache
+         *
+         * If the cache is enabled, each thread remembers the last
+         * instances of each service type, returned by
+         * @ref GetRequiredService() from the last few containers, if
+         * the service is a singleton or a scoped service. Repeated
+         * resolutions of the service from the same container then cost
+         * a generation check and a @ref std::weak_ptr lock (see
+         * @ref impl::ResolutionCache). Registering a service in the
+         * container changes its generation, so all the cached
+         * instances are invalidated.
+         *
+         * Scopes, created after the cache is enabled, use it too.
+         *
+         * @param isEnabled `true` to enable the cache, `false` to disable it
+         */
+        void EnableResolutionCache(bool isEnabled = true)
+        {
+            m_IsResolutionCacheEnabled.store(isEnabled, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Tells if the thread-local resolution cache is enabled
+         * @returns `true` if the cache is enabled, `false` otherwise
+         * @see EnableResolutionCache()
+         */
+        bool IsResolutionCacheEnabled() const
+        {
+            return m_IsResolutionCacheEnabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Creates the singleton services in advance
+         *
+         * The singletons are created in dependency order: a singleton
+         * is created only after the singletons it depends on, and
+         * independent singletons are created concurrently. The method
+         * returns when all the singletons are created.
+         *
+         * The dependencies are known in advance only for the services,
+         * registered with @ref Inject. Other singletons resolve their
+         * dependencies when they are created, and wait for them,
+         * if another thread is creating them.
+         *
+         * If the threading policy isn't thread-safe, or the container
+         * may be used only by its own thread until it's frozen and it's
+         * not frozen yet, the singletons are created on the calling thread.
+         *
+         * @param threadCount number of threads, including the calling thread
+         * @throws any exception, thrown by a factory function
+         */
+        void WarmUp(size_t threadCount = std::thread::hardware_concurrency()) const
+        {
+            auto warmUp = CreateWarmUp(GetSingletons(), threadCount);
+            RunWarmUp(warmUp, threadCount);
+        }
+
+        /**
+         * @brief Creates the singleton services in advance,
+         * using an executor
+         *
+         * It's the same as @ref WarmUp(size_t), but the singletons
+         * are created by tasks, submitted to @p executor.
+         *
+         * @tparam TExecutor executor type
+         * @param executor callable, which accepts a `std::function<void()>`
+         * task and runs it, e.g. on a thread pool
+         * @param concurrency number of tasks to submit
+         * @throws any exception, thrown by a factory function
+         */
+        template <class TExecutor>
+        void WarmUp(TExecutor&& executor, size_t concurrency) const
+        {
+            auto warmUp = CreateWarmUp(GetSingletons(), concurrency);
+
+            if (warmUp == nullptr)
+                return;
+
+            for (size_t i = 0; i < concurrency; i++)
+                executor(std::function<void()>([warmUp]() { warmUp->Run(); }));
+
+            warmUp->Wait();
+        }
+
+        /**
+         * @brief Starts recording the singleton and shared services,
+         * which are created by the container and its scopes
+         *
+         * Only the services, which are created within @p window after
+         * the call, are recorded. The services are recorded in the order
+         * they were created in, together with their factories durations.
+         *
+         * @param window duration of the recording
+         * @see GetStartupProfile()
+         */
+        void StartRecording(std::chrono::steady_clock::duration window) const
+        {
+            m_StartupRecorder->Start(window);
+        }
+
+        /**
+         * @brief Gets the recorded startup profile
+         * @returns the recorded startup profile
+         * @see StartRecording()
+         */
+        StartupProfile GetStartupProfile() const
+        {
+            return m_StartupRecorder->GetProfile();
+        }
+
+        /**
+         * @brief Creates the services from a startup profile
+         * in the background
+         *
+         * The singleton and shared services, which are listed in the
+         * profile, are created in the order of decreasing factory
+         * duration, after the services they depend on (see
+         * @ref WarmUp()). Other services stay lazy. A prewarmed shared
+         * service instance is kept alive until the service is
+         * resolved for the first time.
+         *
+         * If the threading policy isn't thread-safe, or the container
+         * may be used only by its own thread until it's frozen and it's
+         * not frozen yet, the services are created on the calling thread.
+         *
+         * @warning The container must not be destroyed
+         * until the returned future is ready
+         * @param profile the startup profile
+         * @param threadCount number of threads to use
+         * @returns future, which becomes ready when all the services
+         * are created, and rethrows the first exception, thrown
+         * by a factory function
+         */
+        std::future<void> Prewarm(const StartupProfile& profile, size_t threadCount = 1) const
+        {
+            auto warmUp = CreateWarmUp(GetProfiledServices(profile), threadCount);
+
+            if (warmUp == nullptr)
+            {
+                std::promise<void> promise;
+                promise.set_value();
+                return promise.get_future();
+            }
+
+            return std::async(std::launch::async, [warmUp, threadCount]() { RunWarmUp(warmUp, threadCount); });
+        }
+
+        /**
+         * @brief Gets the startup recorder
+         * @returns pointer to the startup recorder
+         * @warning This method is intended for use
+         * by the DI services only
+         */
+        impl::StartupRecorder* GetStartupRecorder() const { return m_StartupRecorder.get(); }
+
         /**
          * @brief Registers a service with singleton lifetime
+         *
+         * The factory function is stored as is, without wrapping
+         * it into a @ref Factory, so it may be inlined.
+         *
          * @tparam T service type
+         * @tparam TFactory factory function type
          * @param factory factory function
          */
-        template<class T>
-        void RegisterSingletonService(Factory<T> factory)
+        template<class T, class TFactory, std::enable_if_t<impl::IsFactoryFor<TFactory, T, BasicContainer>, bool> = true>
+        void RegisterSingletonService(TFactory factory)
         {
-            auto lock = LockMutex();
-            m_RegisteredServices.template RegisterSingletonService<T>(factory);
+            auto lock = LockMutexForWriting();
+            MutableRegisteredServices().template RegisterSingletonService<T>(std::move(factory));
         }
 
         /**
@@ -155,44 +512,137 @@ namespace sol::di
             if (instance == nullptr)
                 throw std::invalid_argument("instance was nullptr");
 
-            auto lock = LockMutex();
-            m_RegisteredServices.template RegisterSingletonService<T>(instance);
+            auto lock = LockMutexForWriting();
+            MutableRegisteredServices().template RegisterSingletonService<T>(instance);
+        }
+
+        /**
+         * @brief Registers a service with singleton lifetime, which
+         * is constructed from the injected services
+         * @tparam T service type
+         * @tparam TImplementation type of the service implementation
+         * @tparam TDependencies types of the injected services
+         * @see Inject
+         */
+        template<class T, class TImplementation = T, class...TDependencies>
+        void RegisterSingletonService(Inject<TDependencies...>)
+        {
+            RegisterSingletonService<T>(impl::InjectFactory<TThreadingPolicy, TImplementation, TDependencies...>());
+        }
+
+        /**
+         * @brief Registers a value
+         *
+         * The value is stored inline in its registration, without
+         * a @ref std::shared_ptr of its own, so it suits small
+         * configuration structures. It's resolved like a singleton,
+         * and may also be resolved by reference
+         * (see @ref GetRequiredServiceRef()).
+         *
+         * @tparam T service type
+         * @param value the value
+         */
+        template<class T>
+        void RegisterValue(T value)
+        {
+            auto lock = LockMutexForWriting();
+            MutableRegisteredServices().template RegisterValue<T>(std::move(value));
         }
 
         /**
          * @brief Registers a service with transient lifetime
          * @tparam T service type
+         * @tparam TFactory factory function type
          * @param factory factory function
          */
-        template<class T>
-        void RegisterTransientService(Factory<T> factory)
+        template<class T, class TFactory, std::enable_if_t<impl::IsFactoryFor<TFactory, T, BasicContainer>, bool> = true>
+        void RegisterTransientService(TFactory factory)
         {
-            auto lock = LockMutex();
-            m_RegisteredServices.template RegisterTransientService<T>(factory);
+            auto lock = LockMutexForWriting();
+            MutableRegisteredServices().template RegisterTransientService<T>(std::move(factory));
+        }
+
+        /**
+         * @brief Registers a service with transient lifetime, which
+         * is constructed from the injected services
+         * @tparam T service type
+         * @tparam TImplementation type of the service implementation
+         * @tparam TDependencies types of the injected services
+         * @see Inject
+         */
+        template<class T, class TImplementation = T, class...TDependencies>
+        void RegisterTransientService(Inject<TDependencies...>)
+        {
+            RegisterTransientService<T>(impl::InjectFactory<TThreadingPolicy, TImplementation, TDependencies...>());
         }
 
         /**
          * @brief Registers a service with shared lifetime
          * @tparam T service type
+         * @tparam TFactory factory function type
          * @param factory factory function
          */
-        template<class T>
-        void RegisterSharedService(Factory<T> factory)
+        template<class T, class TFactory, std::enable_if_t<impl::IsFactoryFor<TFactory, T, BasicContainer>, bool> = true>
+        void RegisterSharedService(TFactory factory)
+        {
+            auto lock = LockMutexForWriting();
+            MutableRegisteredServices().template RegisterSharedService<T>(std::move(factory));
+        }
+
+        /**
+         * @brief Registers a service with shared lifetime, which
+         * is constructed from the injected services
+         * @tparam T service type
+         * @tparam TImplementation type of the service implementation
+         * @tparam TDependencies types of the injected services
+         * @see Inject
+         */
+        template<class T, class TImplementation = T, class...TDependencies>
+        void RegisterSharedService(Inject<TDependencies...>)
         {
-            auto lock = LockMutex();
-            m_RegisteredServices.template RegisterSharedService<T>(factory);
+            RegisterSharedService<T>(impl::InjectFactory<TThreadingPolicy, TImplementation, TDependencies...>());
         }
 
         /**
          * @brief Registers a service with scoped lifetime
+         *
+         * Scopes don't copy the factory function.
+         *
          * @tparam T service type
+         * @tparam TFactory factory function type
          * @param factory factory function
          */
-        template<class T>
-        void RegisterScopedService(Factory<T> factory)
+        template<class T, class TFactory, std::enable_if_t<impl::IsFactoryFor<TFactory, T, BasicContainer>, bool> = true>
+        void RegisterScopedService(TFactory factory)
+        {
+            auto lock = LockMutexForWriting();
+            MutableScopedServiceBuilders().template RegisterScopedService<T>(std::move(factory));
+        }
+
+        /**
+         * @brief Registers a service with scoped lifetime, which
+         * is constructed from the injected services
+         *
+         * By default the instances are allocated the same way as by
+         * @ref FACTORY(), so they may outlive the scope they are
+         * resolved from.
+         *
+         * @tparam T service type
+         * @tparam TImplementation type of the service implementation
+         * @tparam TDependencies types of the injected services
+         * @param allocateFromArena `true` if the instances should be
+         * allocated from the memory arena of the scope they are
+         * resolved from, like by @ref ARENA_FACTORY()
+         * @warning Instances, allocated from the arena, must not
+         * outlive the scope, i.e. neither the caller, nor transient
+         * or shared services may keep them after the scope is destroyed.
+         * @see Inject
+         */
+        template<class T, class TImplementation = T, class...TDependencies>
+        void RegisterScopedService(Inject<TDependencies...>, bool allocateFromArena = false)
         {
-            auto lock = LockMutex();
-            m_ScopedServiceBuilders.template RegisterScopedService<T>(factory);
+            RegisterScopedService<T>(
+                impl::InjectFactory<TThreadingPolicy, TImplementation, TDependencies...>(allocateFromArena));
         }
 
         /**
@@ -204,7 +654,20 @@ namespace sol::di
          */
         void RegisterService(std::type_index type, DIServicePtr diService)
         {
-            m_RegisteredServices.RegisterService(type, diService);
+            RegisterService(impl::GetTypeId(type), diService);
+        }
+
+        /**
+         * @brief Registers a service
+         * @param typeId service type ID
+         * @param diService pointer to a DI service instance
+         * @warning This method is intended for use by the
+         * @ref ContainerBuilder class only
+         */
+        void RegisterService(impl::TypeId typeId, DIServicePtr diService)
+        {
+            ThrowIfFrozen();
+            MutableRegisteredServices().RegisterService(typeId, diService);
         }
 
         /**
@@ -216,7 +679,20 @@ namespace sol::di
          */
         void RegisterScopedServiceBuilder(std::type_index type, ScopedServiceBuilderPtr serviceBuilder)
         {
-            m_ScopedServiceBuilders.RegisterScopedService(type, serviceBuilder);
+            RegisterScopedServiceBuilder(impl::GetTypeId(type), serviceBuilder);
+        }
+
+        /**
+         * @brief Registers a scoped service builder
+         * @param typeId service type ID
+         * @param serviceBuilder service builder
+         * @warning This method is intended for use by the
+         * @ref ContainerBuilder class only
+         */
+        void RegisterScopedServiceBuilder(impl::TypeId typeId, ScopedServiceBuilderPtr serviceBuilder)
+        {
+            ThrowIfFrozen();
+            MutableScopedServiceBuilders().RegisterScopedService(typeId, serviceBuilder);
         }
 
         /**
@@ -228,8 +704,67 @@ namespace sol::di
         template<class T>
         ServicePtr<T> GetRequiredService() const
         {
-            auto lock = LockMutex();
-            return m_RegisteredServices.template GetRequiredService<T>(*this);
+            if (IsResolutionCacheEnabled())
+                return GetRequiredServiceCached<T>();
+
+            return VisitRegisteredServices([this](const RegisteredServices& services)
+            {
+                return services.template GetRequiredService<T>(*this);
+            });
+        }
+
+        /**
+         * @brief Resolves a required service by reference
+         *
+         * Unlike @ref GetRequiredService(), it doesn't copy
+         * a @ref std::shared_ptr, so resolving the same service from
+         * many threads doesn't contend on its reference counter.
+         *
+         * Only singletons, values (see @ref RegisterValue()) and scoped
+         * services can be resolved by reference. The reference is valid
+         * while the container, which the service is registered in,
+         * exists. For scoped services that's the scope the service is
+         * resolved from, and a pooled scope invalidates the reference
+         * when it's returned to the pool.
+         *
+         * @tparam T service type
+         * @returns reference to the instance of the service
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         * @throws sol::di::exc::ServiceNotBorrowableException
+         */
+        template<class T>
+        T& GetRequiredServiceRef() const
+        {
+            return VisitRegisteredServices([this](const RegisteredServices& services) -> T&
+            {
+                return services.template FindDIService<T, false>()->template Borrow<T>(*this);
+            });
+        }
+
+        /**
+         * @brief Resolves several required services at once
+         *
+         * All the services are resolved from the same snapshot of
+         * the registered services, so the container is locked
+         * only once instead of once per service.
+         *
+         * @tparam T services types
+         * @returns @ref std::tuple of pointers to instances of the services
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         * @see FROM_DI_ALL
+         */
+        template <class...T>
+        std::tuple<ServicePtr<T>...> GetRequiredServices() const
+        {
+            static_assert(sizeof...(T) > 0, "At least one service type must be specified");
+
+            return VisitRegisteredServices([this](const RegisteredServices& services)
+            {
+                // Braced initialization resolves the services in order
+                return std::tuple<ServicePtr<T>...> {
+                    services.template GetRequiredService<T>(*this)...
+                };
+            });
         }
 
         /**
@@ -241,8 +776,31 @@ namespace sol::di
         template <class T>
         ServicePtr<T> GetService() const
         {
-            auto lock = LockMutex();
-            return m_RegisteredServices.template GetService<T>(*this);
+            return VisitRegisteredServices([this](const RegisteredServices& services)
+            {
+                return services.template GetService<T>(*this);
+            });
+        }
+
+        /**
+         * @brief Gets a handle, which resolves a required service
+         * without searching the registered services
+         *
+         * The handle is bound to the DI service, which is currently
+         * resolved for the type. If the service is a scoped service,
+         * the handle is bound to its registration instead, and it
+         * resolves the service from any scope, created from this
+         * container.
+         *
+         * @tparam T service type
+         * @returns the handle
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         * @see ServiceHandle
+         */
+        template <class T>
+        ServiceHandle<T, TThreadingPolicy> GetHandle() const
+        {
+            return ServiceHandle<T, TThreadingPolicy>(*this);
         }
 
         /**
@@ -254,47 +812,183 @@ namespace sol::di
         template <class T>
         std::vector<ServicePtr<T>> GetServices() const
         {
-            auto lock = LockMutex();
-            return m_RegisteredServices.template GetServices<T>(*this);
+            return VisitRegisteredServices([this](const RegisteredServices& services)
+            {
+                return services.template GetServices<T>(*this);
+            });
+        }
+
+        /**
+         * @brief Resolves services and invokes a callback for each
+         * of the instances in registration order
+         *
+         * Unlike @ref GetServices(), this method doesn't allocate.
+         *
+         * @tparam T the service type
+         * @tparam TCallback callback type
+         * @param callback callback, which accepts a pointer
+         * to a service instance
+         */
+        template <class T, class TCallback>
+        void ForEachService(TCallback&& callback) const
+        {
+            VisitRegisteredServices([this, &callback](const RegisteredServices& services)
+            {
+                services.template ForEachService<T>(*this, callback);
+            });
+        }
+
+        /**
+         * @brief Gets a view of the services, registered for a type
+         *
+         * If there are services, registered for the type, and all of them
+         * are singletons, they are resolved once and the view keeps the
+         * instances, so iterating over the view neither allocates nor
+         * searches the registered services.
+         *
+         * @tparam T the service type
+         * @returns the view
+         * @see ServicesView
+         */
+        template <class T>
+        ServicesView<T, TThreadingPolicy> GetServicesView() const
+        {
+            return ServicesView<T, TThreadingPolicy>(*this);
         }
 
     private:
-        #ifndef SOLINJECT_NOTHREADSAFE
-            using Mutex = std::recursive_mutex;
-            using Lock = std::lock_guard<Mutex>;
-            using ScopedLock = std::scoped_lock<Mutex, Mutex>;
-        #else
-            using Mutex = impl::Empty;
-            using Lock = impl::Empty;
-            using ScopedLock = impl::Empty;
-        #endif
+        template <class>
+        friend class BasicScopePool;
+
+        template <class, class>
+        friend class ServiceHandle;
+
+        template <class, class>
+        friend class impl::UnownedServiceHandle;
+
+        template <class, class>
+        friend class ServicesView;
+
+        template <class, class, class...>
+        friend class impl::InjectFactory;
+
+        template <class>
+        friend class BasicResolutionContext;
+
+        /// @copydoc impl::RegisteredServices
+        using RegisteredServices = impl::RegisteredServices<TThreadingPolicy>;
+
+        /// @copydoc impl::RegisteredService
+        using RegisteredService = impl::RegisteredService<TThreadingPolicy>;
+
+        /// @copydoc impl::ScopedServiceBuilders
+        using ScopedServiceBuilders = impl::ScopedServiceBuilders<TThreadingPolicy>;
+
+        /// @copydoc impl::ScopedServiceSlots
+        using ScopedServiceSlots = impl::ScopedServiceSlots<TThreadingPolicy>;
+
+        /// @copydoc impl::ScopeArena
+        using ScopeArena = impl::ScopeArena<TThreadingPolicy>;
+
+        /// @copydoc impl::ServiceWarmUp
+        using ServiceWarmUp = impl::ServiceWarmUp<TThreadingPolicy>;
+
+        /// Field, indicating if the threading policy guards the container with a mutex
+        static constexpr bool HasMutex = !std::is_void_v<typename TThreadingPolicy::Mutex>;
+
+        using Mutex = impl::ContainerMutex<typename TThreadingPolicy::Mutex>;
+        using UniqueLock = std::conditional_t<HasMutex, std::unique_lock<Mutex>, impl::Empty>;
+        using ReadLock = std::conditional_t<HasMutex, std::shared_lock<Mutex>, impl::Empty>;
+        using ScopedLock = std::scoped_lock<Mutex, Mutex>;
+
+        /**
+         * @brief Swaps two @ref BasicContainer instances
+         * without locking their mutexes
+         */
+        static void SwapUnlocked(BasicContainer& a, BasicContainer& b) noexcept
+        {
+            using std::swap;
+
+            swap(a.m_RegisteredServices, b.m_RegisteredServices);
+            swap(a.m_ScopedServiceBuilders, b.m_ScopedServiceBuilders);
+            swap(a.m_IsThreadSafe, b.m_IsThreadSafe);
+            swap(a.m_OwnerThreadId, b.m_OwnerThreadId);
+            swap(a.m_StartupRecorder, b.m_StartupRecorder);
+            swap(a.m_IsScope, b.m_IsScope);
+            swap(a.m_Arena, b.m_Arena);
+            swap(a.m_ScopedSlots, b.m_ScopedSlots);
 
-        using MutexPtr = std::shared_ptr<Mutex>;
+            bool isFrozen = a.m_IsFrozen.load();
+            a.m_IsFrozen.store(b.m_IsFrozen.load());
+            b.m_IsFrozen.store(isFrozen);
+
+            // Generations are unique, so the cached
+            // instances of both containers are invalidated
+            auto generation = a.m_Generation.load();
+            a.m_Generation.store(b.m_Generation.load());
+            b.m_Generation.store(generation);
+            swap(a.m_ParentGeneration, b.m_ParentGeneration);
+
+            bool isResolutionCacheEnabled = a.m_IsResolutionCacheEnabled.load();
+            a.m_IsResolutionCacheEnabled.store(b.m_IsResolutionCacheEnabled.load());
+            b.m_IsResolutionCacheEnabled.store(isResolutionCacheEnabled);
+        }
+
+        /// Pointer to registered services
+        using RegisteredServicesPtr = std::shared_ptr<RegisteredServices>;
+
+        /// Pointer to immutable registered services
+        using RegisteredServicesConstPtr = typename RegisteredServices::ConstPtr;
 
         /**
          * @brief Scoped container constructor
          * @param services registered services
-         * @param mutexPtr pointer to a mutex
+         * @param isThreadSafe `false` if the scope is used
+         * by one thread at a time, so it doesn't need locking
+         * @param startupRecorder pointer to the startup recorder
          */
-        Container(
-            impl::RegisteredServices&& services,
-            MutexPtr mutexPtr
+        BasicContainer(
+            RegisteredServices&& services,
+            bool isThreadSafe,
+            std::shared_ptr<impl::StartupRecorder> startupRecorder
         ) :
-            m_RegisteredServices(std::move(services)),
-            m_Mutex(mutexPtr),
-            m_IsScope(true)
+            m_RegisteredServices(std::make_shared<RegisteredServices>(std::move(services))),
+            m_ScopedServiceBuilders(std::make_shared<ScopedServiceBuilders>()),
+            m_IsThreadSafe(isThreadSafe),
+            m_StartupRecorder(std::move(startupRecorder)),
+            m_IsScope(true),
+            m_Arena(m_RegisteredServices->GetArena()),
+            m_ScopedSlots(m_RegisteredServices->GetScopedSlots())
         {
-            solinject_req_assert(mutexPtr != nullptr);
         }
 
-        /// Registered services
-        impl::RegisteredServices m_RegisteredServices;
+        /// Pointer to the registered services
+        RegisteredServicesPtr m_RegisteredServices;
 
-        /// Scoped service builders
-        impl::ScopedServiceBuilders m_ScopedServiceBuilders;
+        /// Pointer to the scoped service builders
+        std::shared_ptr<ScopedServiceBuilders> m_ScopedServiceBuilders;
 
-        /// Pointer to a mutex
-        MutexPtr m_Mutex;
+        /// Mutex, which is discarded if the threading policy doesn't use one
+        mutable impl::DiscardableMutex<Mutex, HasMutex> m_Mutex;
+
+        /**
+         * @brief Field, indicating if the container may be used by
+         * several threads at once, so it locks its mutex
+         *
+         * It's `false` for single-threaded scopes and containers,
+         * whose threading policy isn't thread-safe.
+         */
+        bool m_IsThreadSafe = TThreadingPolicy::IsThreadSafe;
+
+        /**
+         * @brief ID of the thread, which may use the container until it's
+         * frozen, if the threading policy requires it
+         * @see ExclusiveMutexPolicy::IsOwnedUntilFrozen
+         */
+        std::thread::id m_OwnerThreadId = std::this_thread::get_id();
+
+        /// Pointer to the startup recorder, which is shared with the scopes
+        std::shared_ptr<impl::StartupRecorder> m_StartupRecorder;
 
         /**
          * @brief Field, indicating if the container
@@ -302,13 +996,559 @@ namespace sol::di
          */
         bool m_IsScope = false;
 
+        /// Field, indicating if the container is frozen
+        std::atomic<bool> m_IsFrozen = false;
+
+        /**
+         * @brief Generation of the container's registrations,
+         * which is changed when a service is registered
+         * @see impl::ResolutionCache
+         */
+        std::atomic<impl::ContainerGeneration> m_Generation = impl::NextContainerGeneration();
+
+        /**
+         * @brief Generation of the parent container's registrations
+         * at the moment the scope was created or `0` if the container
+         * is not a scope
+         * @see GetRegistrationGeneration()
+         */
+        impl::ContainerGeneration m_ParentGeneration = 0;
+
+        /// Field, indicating if the thread-local resolution cache is enabled
+        std::atomic<bool> m_IsResolutionCacheEnabled = false;
+
+        /**
+         * @brief Pointer to the scope's memory arena or `nullptr`
+         * if the container is not a scope
+         *
+         * The arena is owned by the registered services.
+         */
+        ScopeArena* m_Arena = nullptr;
+
+        /**
+         * @brief Pointer to the scope's scoped service slots or
+         * `nullptr` if the container is not a scope or has no slots
+         *
+         * The slots are owned by the registered services.
+         */
+        ScopedServiceSlots* m_ScopedSlots = nullptr;
+
         /**
          * @brief Locks the mutex
+         * @returns a lock object, which doesn't own
+         * a mutex if the container doesn't have one
+         */
+        UniqueLock LockMutex() const
+        {
+            if constexpr (HasMutex)
+                if (m_IsThreadSafe)
+                    return UniqueLock(m_Mutex);
+
+            return UniqueLock();
+        }
+
+        /**
+         * @brief Locks the mutex for reading the registered services
+         *
+         * If the threading policy uses a shared mutex, the mutex is
+         * locked in shared mode, so readers don't block each other.
+         *
+         * @returns a lock object
+         * @throws sol::di::exc::ContainerNotFrozenException
+         */
+        ReadLock LockMutexForReading() const
+        {
+            ThrowIfNotOwned();
+
+            if constexpr (HasMutex)
+                if (m_IsThreadSafe)
+                    return ReadLock(m_Mutex);
+
+            return ReadLock();
+        }
+
+        /**
+         * @brief Locks the mutex for registering a service
          * @returns a lock object
+         * @throws sol::di::exc::ContainerFrozenException
+         * @throws sol::di::exc::ContainerNotFrozenException
+         */
+        UniqueLock LockMutexForWriting() const
+        {
+            UniqueLock lock = LockMutex();
+            ThrowIfNotOwned();
+            ThrowIfFrozen();
+            return lock;
+        }
+
+        /**
+         * @brief Locks the mutex for reading the registered
+         * services if the container is not frozen
+         * @returns a lock object, which doesn't own
+         * the mutex if the container is frozen
+         * @see LockMutexForReading()
          */
-        Lock LockMutex() const
+        ReadLock LockMutexUnlessFrozen() const
         {
-            return Lock(*m_Mutex);
+            if (IsFrozen())
+                return ReadLock();
+
+            return LockMutexForReading();
         }
-    }; // class Container
+
+        /**
+         * @brief Invokes a callback with the registered services
+         *
+         * The mutex is held only while the registered services are
+         * being pinned. Registering a service never modifies a pinned
+         * collection (see @ref MutableRegisteredServices()), so the callback
+         * can resolve services without the mutex, and different services
+         * can be created concurrently.
+         *
+         * @tparam TCallback callback type
+         * @param callback callback, which accepts a `const` reference
+         * to @ref impl::RegisteredServices
+         * @returns the value, returned by the callback
+         */
+        template <class TCallback>
+        decltype(auto) VisitRegisteredServices(TCallback&& callback) const
+        {
+            if (IsFrozen())
+                return callback(*m_RegisteredServices);
+
+            RegisteredServicesConstPtr services;
+
+            {
+                auto lock = LockMutexForReading();
+                services = RegisteredServicesConstPtr(m_RegisteredServices);
+            }
+
+            return callback(*services);
+        }
+
+        /**
+         * @brief Gets the generation, which identifies
+         * the registrations services are resolved from
+         *
+         * A scope without its own registrations resolves services
+         * the same way as its parent container did when the scope
+         * was created, so it has the generation of the parent.
+         *
+         * @warning The mutex must be locked by the caller
+         * unless the container is frozen
+         * @returns the generation of the registrations
+         */
+        impl::ContainerGeneration GetRegistrationGeneration() const
+        {
+            if (m_IsScope && !m_RegisteredServices->HasOwnServices() && m_ScopedServiceBuilders->IsEmpty())
+                return m_ParentGeneration;
+
+            return m_Generation.load(std::memory_order_acquire);
+        }
+
+        /**
+         * @brief Gets the key of the resolution plans, which
+         * may be executed to resolve services from this container
+         *
+         * Generations are never reused, so a plan, compiled for a
+         * destroyed container, is never executed by another container.
+         *
+         * @returns the key of the resolution plans or `0`
+         * if the container is not frozen
+         */
+        impl::ContainerGeneration GetResolutionPlanKey() const
+        {
+            return IsFrozen() ? GetRegistrationGeneration() : 0;
+        }
+
+        /**
+         * @brief Gets the singleton services
+         * @returns the singleton DI services
+         */
+        std::vector<DIServicePtr> GetSingletons() const
+        {
+            std::vector<DIServicePtr> singletons;
+
+            VisitRegisteredServices([&singletons](const RegisteredServices& services)
+            {
+                services.ForEachRegisteredService([&singletons](const RegisteredService& diService)
+                {
+                    if (diService.DIService()->Lifetime() == ServiceLifetime::Singleton)
+                        singletons.push_back(diService.DIService());
+                });
+            });
+
+            return singletons;
+        }
+
+        /**
+         * @brief Gets the singleton and shared services,
+         * which are listed in a startup profile
+         * @param profile the startup profile
+         * @returns the DI services in the order
+         * of decreasing factory duration
+         */
+        std::vector<DIServicePtr> GetProfiledServices(const StartupProfile& profile) const
+        {
+            using Duration = std::chrono::microseconds;
+
+            std::unordered_map<std::string, Duration> durations;
+
+            for (const auto& entry : profile.Entries())
+            {
+                if (entry.lifetime != ServiceLifetime::Singleton && entry.lifetime != ServiceLifetime::Shared)
+                    continue;
+
+                Duration& duration = durations[entry.serviceType];
+                duration = std::max(duration, entry.duration);
+            }
+
+            std::vector<std::pair<Duration, DIServicePtr>> services;
+            std::unordered_set<const impl::IService<TThreadingPolicy>*> addedServices;
+
+            VisitRegisteredServices([&](const RegisteredServices& registeredServices)
+            {
+                registeredServices.ForEachRegisteredService([&](const RegisteredService& diService)
+                {
+                    const DIServicePtr& service = diService.DIService();
+                    ServiceLifetime lifetime = service->Lifetime();
+
+                    if (lifetime != ServiceLifetime::Singleton && lifetime != ServiceLifetime::Shared)
+                        return;
+
+                    auto it = durations.find(service->ServiceType().name());
+
+                    if (it != durations.end() && addedServices.insert(service.get()).second)
+                        services.emplace_back(it->second, service);
+                });
+            });
+
+            std::stable_sort(services.begin(), services.end(), [](const auto& a, const auto& b)
+            {
+                return a.first > b.first;
+            });
+
+            std::vector<DIServicePtr> orderedServices;
+            orderedServices.reserve(services.size());
+
+            for (auto& service : services)
+                orderedServices.push_back(std::move(service.second));
+
+            return orderedServices;
+        }
+
+        /**
+         * @brief Finds the dependencies between services to warm up
+         *
+         * The dependencies of a service are known in advance only if its
+         * factory function lists them (see @ref Inject). A dependency,
+         * which is not warmed up itself (e.g. a transient service), is
+         * followed to its own dependencies.
+         *
+         * @param[in] services DI services to warm up
+         * @returns for each service, indices of the services,
+         * which it depends on
+         */
+        std::vector<std::vector<size_t>> GetWarmUpDependencies(const std::vector<DIServicePtr>& services) const
+        {
+            using IService = impl::IService<TThreadingPolicy>;
+
+            std::unordered_map<const IService*, size_t> indices;
+
+            for (size_t index = 0; index < services.size(); index++)
+                indices.emplace(services[index].get(), index);
+
+            std::vector<std::vector<size_t>> dependencies(services.size());
+
+            VisitRegisteredServices([&](const RegisteredServices& registeredServices)
+            {
+                std::vector<impl::TypeId> typeIds;
+                std::vector<const IService*> pendingServices;
+                std::unordered_set<const IService*> visitedServices;
+
+                for (size_t index = 0; index < services.size(); index++)
+                {
+                    pendingServices.assign(1, services[index].get());
+                    visitedServices.clear();
+
+                    while (!pendingServices.empty())
+                    {
+                        const IService* service = pendingServices.back();
+                        pendingServices.pop_back();
+
+                        typeIds.clear();
+
+                        if (!service->GetDependencies(typeIds))
+                            continue;
+
+                        for (impl::TypeId typeId : typeIds)
+                        {
+                            const RegisteredService* dependency = registeredServices.FindDIService(typeId);
+
+                            if (dependency == nullptr || !visitedServices.insert(dependency->DIService().get()).second)
+                                continue;
+
+                            if (auto it = indices.find(dependency->DIService().get()); it != indices.end())
+                                dependencies[index].push_back(it->second);
+                            else
+                                pendingServices.push_back(dependency->DIService().get());
+                        }
+                    }
+                }
+            });
+
+            return dependencies;
+        }
+
+        /**
+         * @brief Prepares a warm-up of services
+         *
+         * If the services can't be created by other threads (see
+         * @ref WarmUp()), they are created right away.
+         *
+         * @param services DI services to warm up in order
+         * @param[in,out] workerCount number of workers. It's reduced
+         * if there are fewer services than workers.
+         * @returns pointer to the warm-up or `nullptr`
+         * if there is nothing left to create
+         */
+        std::shared_ptr<ServiceWarmUp> CreateWarmUp(std::vector<DIServicePtr> services, size_t& workerCount) const
+        {
+            if (!TThreadingPolicy::IsThreadSafe || (TThreadingPolicy::IsOwnedUntilFrozen && !IsFrozen()))
+            {
+                for (const auto& service : services)
+                    service->WarmUp(*this);
+
+                return nullptr;
+            }
+
+            workerCount = std::max<size_t>(1, std::min(workerCount, services.size()));
+
+            if (services.empty())
+                return nullptr;
+
+            auto dependencies = GetWarmUpDependencies(services);
+
+            return std::make_shared<ServiceWarmUp>(*this, std::move(services), dependencies, workerCount);
+        }
+
+        /**
+         * @brief Runs a warm-up on new threads and the calling
+         * thread and waits for it to finish
+         * @param warmUp pointer to the warm-up or `nullptr`
+         * @param threadCount number of threads, including the calling thread
+         * @throws any exception, thrown by a factory function
+         */
+        static void RunWarmUp(const std::shared_ptr<ServiceWarmUp>& warmUp, size_t threadCount)
+        {
+            if (warmUp == nullptr)
+                return;
+
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+
+            for (size_t i = 1; i < threadCount; i++)
+                threads.emplace_back([&warmUp]() { warmUp->Run(); });
+
+            warmUp->Run();
+
+            for (auto& thread : threads)
+                thread.join();
+
+            warmUp->Wait();
+        }
+
+        /**
+         * @brief Gets the registered services for modification
+         *
+         * If the registered services collection is pinned by
+         * scopes or resolutions in progress, it's copied first
+         * (copy-on-write), so the pinned collection stays immutable.
+         *
+         * @warning The mutex must be locked by the caller
+         * @returns the registered services
+         */
+        RegisteredServices& MutableRegisteredServices()
+        {
+            UpdateGeneration();
+            return impl::CopyIfPinned(m_RegisteredServices);
+        }
+
+        /**
+         * @brief Prepares the scoped service builders for modification
+         * @warning The mutex must be locked by the caller
+         * @returns the scoped service builders
+         * @see MutableRegisteredServices()
+         */
+        ScopedServiceBuilders& MutableScopedServiceBuilders()
+        {
+            UpdateGeneration();
+            return impl::CopyIfPinned(m_ScopedServiceBuilders);
+        }
+
+        /**
+         * @brief Changes the generation of the container's registrations,
+         * so the cached instances of its services are invalidated
+         *
+         * Readers load the generation before they pin the registered
+         * services, and the mutex is held until the modification is
+         * finished, so an instance is never cached with the new generation
+         * unless it's resolved from the modified services.
+         *
+         * @warning The mutex must be locked by the caller
+         */
+        void UpdateGeneration()
+        {
+            m_Generation.store(impl::NextContainerGeneration(), std::memory_order_release);
+        }
+
+        /**
+         * @brief Resolves a required service through
+         * the thread-local resolution cache
+         * @tparam T service type
+         * @returns Pointer to an instance of the service
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         * @see EnableResolutionCache()
+         */
+        template <class T>
+        ServicePtr<T> GetRequiredServiceCached() const
+        {
+            using Cache = impl::ResolutionCache<T>;
+
+            auto generation = m_Generation.load(std::memory_order_acquire);
+
+            if (auto instance = Cache::Find(this, generation); instance != nullptr)
+                return instance;
+
+            return VisitRegisteredServices([this, generation](const RegisteredServices& services)
+            {
+                const RegisteredService* diService = services.template FindDIService<T, false>();
+                auto instance = diService->template Resolve<T>(*this);
+
+                if (auto lifetime = diService->DIService()->Lifetime();
+                    lifetime == ServiceLifetime::Singleton || lifetime == ServiceLifetime::Scoped)
+                    Cache::Store(this, generation, instance);
+
+                return instance;
+            });
+        }
+
+        /**
+         * @brief Resets a pooled scope for reuse
+         *
+         * Services, registered in the scope, are removed and scoped
+         * service instances are destroyed and the memory arena is released.
+         * The allocated storage is kept unless it's shared with scopes
+         * of the scope.
+         *
+         * @warning Must not be called while the scope
+         * may be used by other threads
+         */
+        void ResetPooledScope()
+        {
+            solinject_req_assert(m_IsScope);
+
+            m_IsFrozen.store(false, std::memory_order_relaxed);
+            m_ParentGeneration = 0;
+            UpdateGeneration();
+
+            if (!m_RegisteredServices->TryReset())
+            {
+                m_RegisteredServices = std::make_shared<RegisteredServices>(
+                    RegisteredServicesConstPtr(),
+                    nullptr,
+                    std::make_shared<ScopeArena>(m_IsThreadSafe)
+                );
+
+                m_Arena = m_RegisteredServices->GetArena();
+                m_ScopedSlots = nullptr;
+            }
+
+            if (m_ScopedServiceBuilders->IsPinned())
+                m_ScopedServiceBuilders = std::make_shared<ScopedServiceBuilders>();
+            else
+                m_ScopedServiceBuilders->Clear();
+        }
+
+        /**
+         * @brief Rebinds a pooled scope to the current
+         * services of the container it was created from
+         *
+         * The calling thread becomes the owner of the scope.
+         *
+         * @warning Must not be called while the scope
+         * may be used by other threads
+         * @param container the container the scope was created from
+         * @throws sol::di::exc::ContainerNotFrozenException
+         */
+        void RebindPooledScope(const BasicContainer& container)
+        {
+            solinject_req_assert(m_IsScope);
+
+            RegisteredServicesConstPtr parent;
+            typename ScopedServiceBuilders::ConstPtr builders;
+
+            {
+                auto lock = container.LockMutexUnlessFrozen();
+                parent = RegisteredServicesConstPtr(container.m_RegisteredServices);
+                builders = typename ScopedServiceBuilders::ConstPtr(container.m_ScopedServiceBuilders);
+                m_ParentGeneration = container.GetRegistrationGeneration();
+            }
+
+            m_RegisteredServices->Rebind(std::move(parent), std::move(builders));
+            m_ScopedSlots = m_RegisteredServices->GetScopedSlots();
+
+            m_OwnerThreadId = std::this_thread::get_id();
+
+            UpdateGeneration();
+            m_IsResolutionCacheEnabled.store(container.IsResolutionCacheEnabled(), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Throws an exception if the container is frozen
+         * @throws sol::di::exc::ContainerFrozenException
+         */
+        void ThrowIfFrozen() const
+        {
+            solinject_assert(!IsFrozen() && "Services are not registered in a frozen container");
+
+            if (IsFrozen())
+                throw exc::ContainerFrozenException();
+        }
+
+        /**
+         * @brief Throws an exception if the container may be used
+         * only by its own thread until it's frozen, it's not frozen
+         * yet, and it's used by another thread
+         *
+         * Single-threaded scopes are used by one thread at a time
+         * anyway, so they may be passed between threads.
+         *
+         * @throws sol::di::exc::ContainerNotFrozenException
+         */
+        void ThrowIfNotOwned() const
+        {
+            if constexpr (TThreadingPolicy::IsOwnedUntilFrozen)
+            {
+                bool isOwned = !m_IsThreadSafe || IsFrozen() || std::this_thread::get_id() == m_OwnerThreadId;
+
+                solinject_assert(isOwned && "The container is used by other threads only after it's frozen");
+
+                if (!isOwned)
+                    throw exc::ContainerNotFrozenException();
+            }
+        }
+    }; // class BasicContainer
+
+    /**
+     * @brief Dependency Injection container with @ref DefaultThreadingPolicy
+     * @see BasicContainer
+     * @headerfile Container.hpp solinject.hpp
+     */
+    using Container = BasicContainer<DefaultThreadingPolicy>;
 } // sol::di
+
+#include "ServiceHandle.hpp"
+#include "ServicesView.hpp"
+#include "ResolutionContext.hpp"
+#include "InlineCache.hpp"
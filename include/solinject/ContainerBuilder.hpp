@@ -35,19 +35,24 @@
 
 namespace sol::di
 {
-    /// @brief DI @ref Container builder
-    class ContainerBuilder
+    /// @brief DI @ref BasicContainer builder
+    /// @tparam TThreadingPolicy threading policy of the built containers
+    template <class TThreadingPolicy>
+    class BasicContainerBuilder
     {
     public:
-        /// @copydoc Container::Factory
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /// @copydoc BasicContainer::Factory
         template <class T>
-        using Factory = Container::Factory<T>;
+        using Factory = typename Container::template Factory<T>;
 
         /// @copydoc ConfigurationItem::Key
         using Key = ConfigurationItem::Key;
 
         /// Pointer to an @ref impl::IService instance
-        using DIServicePtr = std::shared_ptr<impl::IService>;
+        using DIServicePtr = std::shared_ptr<impl::IService<TThreadingPolicy>>;
 
         /// @brief Registers an interface
         /// @tparam T the interface type
@@ -61,23 +66,28 @@ namespace sol::di
         /// @brief Registers a service
         /// @tparam TService the service type
         /// @tparam ...TServiceParents the service parent types
+        /// @tparam TFactory the service factory type
         /// @param key the service key
         /// @param factory the service factory
         /// @see FACTORY
-        template <class TService, class...TServiceParents>
-        void RegisterService(Key key, Factory<TService> factory)
+        template <class TService, class...TServiceParents, class TFactory>
+        void RegisterService(Key key, TFactory factory)
         {
             using namespace impl;
 
+            static_assert(IsFactoryFor<TFactory, TService, Container>, "The factory must return a pointer to TService");
+
+            using P = TThreadingPolicy;
+
             LifetimeToServiceMap services;
 
-            services[ServiceLifetime::Singleton] = std::make_shared<SingletonService<TService, TServiceParents...>>(factory);
-            services[ServiceLifetime::Transient] = std::make_shared<TransientService<TService, TServiceParents...>>(factory);
-            services[ServiceLifetime::Shared] = std::make_shared<SharedService<TService, TServiceParents...>>(factory);
+            services[ServiceLifetime::Singleton] = std::make_shared<SingletonService<P, TService, TFactory, TServiceParents...>>(factory);
+            services[ServiceLifetime::Transient] = std::make_shared<TransientService<P, TService, TFactory, TServiceParents...>>(factory);
+            services[ServiceLifetime::Shared] = std::make_shared<SharedService<P, TService, TFactory, TServiceParents...>>(factory);
 
             m_RegisteredServices[key] = std::move(services);
             m_RegisteredScopedServiceBuilders[key] =
-                std::make_shared<ScopedServiceBuilder<TService, TServiceParents...>>(factory);
+                std::make_shared<ScopedServiceBuilder<P, TService, TFactory, TServiceParents...>>(std::move(factory));
 
             m_RegisteredInterfaces.try_emplace(key, std::type_index(typeid(TService)));
         }
@@ -130,7 +140,7 @@ namespace sol::di
             return container;
         }
     private:
-        using ScopedServiceBuilderPtr = std::shared_ptr<impl::IScopedServiceBuilder>;
+        using ScopedServiceBuilderPtr = std::shared_ptr<impl::IScopedServiceBuilder<TThreadingPolicy>>;
         using LifetimeToServiceMap = std::map<ServiceLifetime, DIServicePtr>;
         using KeyToTypeMap = std::map<Key, std::type_index>;
         using RegisteredServicesMap = std::map<Key, LifetimeToServiceMap>;
@@ -185,4 +195,8 @@ namespace sol::di
             return result;
         }
     };
+
+    /// @brief DI @ref Container builder
+    /// @see BasicContainerBuilder
+    using ContainerBuilder = BasicContainerBuilder<DefaultThreadingPolicy>;
 }
@@ -0,0 +1,114 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Tuple of arguments, which is expanded into separate
+     * arguments when it's passed to @ref MakeShared()
+     * @tparam TTuple tuple type
+     */
+    template <class TTuple>
+    class ExpandedArgs
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param tuple the arguments
+         */
+        explicit ExpandedArgs(TTuple tuple) : m_Tuple(std::move(tuple))
+        {
+        }
+
+        /**
+         * @brief Takes the arguments
+         * @returns the arguments
+         */
+        TTuple TakeTuple() { return std::move(m_Tuple); }
+
+    private:
+        /// The arguments
+        TTuple m_Tuple;
+    };
+
+    /**
+     * @brief Marks a tuple of arguments for expansion
+     * @tparam TTuple tuple type
+     * @param tuple the arguments
+     * @returns the arguments, marked for expansion
+     */
+    template <class TTuple>
+    ExpandedArgs<std::decay_t<TTuple>> ExpandArgs(TTuple&& tuple)
+    {
+        return ExpandedArgs<std::decay_t<TTuple>>(std::forward<TTuple>(tuple));
+    }
+
+    /// Value, indicating if a type is an @ref ExpandedArgs type
+    template <class T>
+    inline constexpr bool IsExpandedArgs = false;
+
+    /// @copydoc IsExpandedArgs
+    template <class TTuple>
+    inline constexpr bool IsExpandedArgs<ExpandedArgs<TTuple>> = true;
+
+    /**
+     * @brief Converts an argument to a tuple of arguments
+     * @tparam TArg argument type
+     * @param arg the argument
+     * @returns the expanded arguments if @p arg is an @ref ExpandedArgs
+     * instance, or a tuple with a reference to @p arg otherwise
+     */
+    template <class TArg>
+    auto AsArgsTuple(TArg&& arg)
+    {
+        if constexpr (IsExpandedArgs<std::decay_t<TArg>>)
+            return arg.TakeTuple();
+        else
+            return std::forward_as_tuple(std::forward<TArg>(arg));
+    }
+
+    /**
+     * @brief Creates a service instance, expanding
+     * @ref ExpandedArgs constructor arguments
+     * @tparam T service type
+     * @tparam TArgs constructor arguments types
+     * @param args constructor arguments
+     * @returns pointer to the created instance
+     */
+    template <class T, class...TArgs>
+    std::shared_ptr<T> MakeShared(TArgs&&...args)
+    {
+        return std::apply(
+            [](auto&&...expandedArgs)
+            {
+                return std::make_shared<T>(std::forward<decltype(expandedArgs)>(expandedArgs)...);
+            },
+            std::tuple_cat(AsArgsTuple(std::forward<TArgs>(args))...)
+        );
+    }
+}
@@ -0,0 +1,116 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "TypeId.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Value, indicating if a callable can be used
+     * as a factory function of a service
+     *
+     * A factory function accepts a `const` reference to a DI container
+     * and returns a pointer, convertible to `std::shared_ptr<T>`.
+     *
+     * @tparam TFactory callable type
+     * @tparam T service type
+     * @tparam TContainer DI container type
+     */
+    template <class TFactory, class T, class TContainer>
+    inline constexpr bool IsFactoryFor =
+        std::is_invocable_r_v<std::shared_ptr<T>, const TFactory&, const TContainer&>;
+
+    /**
+     * @brief Value, indicating if a factory function can compile
+     * a resolution plan (see @ref IService::CompilePlan())
+     * @tparam TFactory factory function type
+     * @tparam TContainer DI container type
+     */
+    template <class TFactory, class TContainer, class = void>
+    inline constexpr bool HasResolutionPlan = false;
+
+    /// @copydoc HasResolutionPlan
+    template <class TFactory, class TContainer>
+    inline constexpr bool HasResolutionPlan<
+        TFactory,
+        TContainer,
+        std::void_t<decltype(std::declval<TFactory&>().CompilePlan(std::declval<const TContainer&>()))>
+    > = true;
+
+    /**
+     * @brief Value, indicating if a factory function lists the
+     * services it depends on (see @ref IService::GetDependencies())
+     * @tparam TFactory factory function type
+     */
+    template <class TFactory, class = void>
+    inline constexpr bool HasDependencyList = false;
+
+    /// @copydoc HasDependencyList
+    template <class TFactory>
+    inline constexpr bool HasDependencyList<
+        TFactory,
+        std::void_t<decltype(std::declval<const TFactory&>().GetDependencies(std::declval<std::vector<TypeId>&>()))>
+    > = true;
+
+    /**
+     * @brief Non-owning reference to a factory function
+     *
+     * It's used by DI services, which are created from a builder
+     * and don't need their own copy of the builder's factory.
+     *
+     * @tparam TFactory factory function type
+     */
+    template <class TFactory>
+    class FactoryRef
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param factory the factory function, which must
+         * outlive the @ref FactoryRef instance
+         */
+        FactoryRef(const TFactory& factory) : m_Factory(&factory)
+        {
+        }
+
+        /**
+         * @brief Invokes the factory function
+         * @tparam TContainer DI container type
+         * @param container DI container
+         * @returns pointer to a service instance
+         */
+        template <class TContainer>
+        decltype(auto) operator()(const TContainer& container) const
+        {
+            return (*m_Factory)(container);
+        }
+
+    private:
+        /// Pointer to the factory function
+        const TFactory* m_Factory;
+    };
+}
@@ -33,9 +33,43 @@
  * is being linked to a single-threaded program and, therefore,
  * its thread safety measures, such as mutex locks, may be disabled
  * for performance reasons.
+ *
+ * @ref sol::di::Container then uses @ref sol::di::NoThreadingPolicy.
+ * Containers with an explicit threading policy are not affected.
+ *
+ * @see sol::di::DefaultThreadingPolicy
+ * @see sol::di::BasicContainer
  */
 #define SOLINJECT_NOTHREADSAFE
 
+/**
+ * @brief Macro, which, when defined, makes @ref sol::di::Container
+ * use a reader-writer lock instead of an exclusive one.
+ *
+ * Resolving services then locks the container's mutex
+ * in shared mode, so concurrent resolutions don't block
+ * each other, while registering services still locks it
+ * exclusively. Has no effect if @ref SOLINJECT_NOTHREADSAFE
+ * is defined.
+ *
+ * @see sol::di::DefaultThreadingPolicy
+ * @see sol::di::BasicContainer
+ */
+#define SOLINJECT_SHARED_MUTEX
+
+/**
+ * @brief Macro, which, when defined, makes each expansion of
+ * the @ref FROM_DI() and @ref FROM_DI_OPTIONAL() macros keep
+ * a thread-local inline cache of the service lookup.
+ *
+ * Repeated resolutions from the same container skip the lookup
+ * until a service is registered in the container. The services
+ * are still resolved according to their lifetimes.
+ *
+ * @see sol::di::impl::InlineCache
+ */
+#define SOLINJECT_INLINE_CACHE
+
 /**
  * @brief Macro, which, when defined, indicates that solinject
  * is being linked to a tests project.
@@ -25,12 +25,16 @@
 
 namespace sol::di::impl
 {
-    /// Type-erased interface for DI service builders
+    /**
+     * @brief Type-erased interface for DI service builders
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
     class IScopedServiceBuilder
     {
     public:
         /// Pointer to an @ref IService instance
-        using DIServicePtr = std::shared_ptr<IService>;
+        using DIServicePtr = std::shared_ptr<IService<TThreadingPolicy>>;
 
         virtual ~IScopedServiceBuilder() {}
 
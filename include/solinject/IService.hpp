@@ -22,28 +22,106 @@
 
 #pragma once
 #include <memory>
+#include <typeinfo>
+#include <vector>
+#include "TypeId.hpp"
+#include "ServiceLifetime.hpp"
 
-namespace sol::di { class Container; }
+namespace sol::di
+{
+    template <class TThreadingPolicy>
+    class BasicContainer;
+}
 
 namespace sol::di::impl
 {
-    /// Type-erased DI service interface
+    /**
+     * @brief Type-erased DI service interface
+     *
+     * A DI service may be resolvable as several types: the service
+     * type and its parent types. For each of them it implements
+     * @ref IServiceTyped, which is called the service's resolver
+     * for that type.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
     class IService
     {
     public:
         /// DI container
-        using Container = sol::di::Container;
-
-        /// Pointer to void
-        using VoidPtr = std::shared_ptr<void>;
+        using Container = BasicContainer<TThreadingPolicy>;
 
         virtual ~IService() {}
 
         /**
-         * @brief Resolves a service
-         * @param container DI container
-         * @returns A service instance as @ref VoidPtr
+         * @brief Gets the resolver for a type
+         *
+         * It's called once on registration, and the result is stored
+         * next to the service, so resolving doesn't need to cast.
+         *
+         * @param typeId ID of the type to resolve the service as
+         * @returns pointer to the service's @ref IServiceTyped<T>
+         * base, where `T` is the type with ID @p typeId, or `nullptr`
+         * if the service isn't resolvable as that type
+         */
+        virtual void* GetResolver(TypeId typeId) = 0;
+
+        /**
+         * @brief Gets the lifetime of the service
+         * @returns the lifetime of the service
+         */
+        virtual ServiceLifetime Lifetime() const = 0;
+
+        /**
+         * @brief Gets the service type
+         * @returns the service type
+         */
+        virtual const std::type_info& ServiceType() const = 0;
+
+        /**
+         * @brief Destroys the service instance, so that the next
+         * resolution creates a new one
+         *
+         * Only scoped services support resetting. It's used for reusing
+         * pooled scopes, so it must not be called while the service
+         * may be resolved by other threads.
+         */
+        virtual void Reset() {}
+
+        /**
+         * @brief Creates the service instance in advance,
+         * so that the first resolution doesn't have to
+         *
+         * Only singleton and shared services support warming up.
+         * A warmed up shared service instance is kept alive until
+         * the service is resolved for the first time.
+         *
+         * @param[in] container DI container
+         */
+        virtual void WarmUp(const Container& container) {}
+
+        /**
+         * @brief Compiles the resolution plan of the service, if its
+         * factory function supports it (see @ref InjectFactory)
+         *
+         * It's called when the container is frozen.
+         *
+         * @param[in] container the frozen DI container
+         */
+        virtual void CompilePlan(const Container& container) {}
+
+        /**
+         * @brief Gets the types of the services, which the service
+         * depends on, if its factory function lists them
+         * (see @ref InjectFactory)
+         *
+         * It's used for creating the services in dependency
+         * order during a warm-up.
+         *
+         * @param[out] dependencies vector, which the type IDs are added to
+         * @returns `true` if the dependencies are known, `false` otherwise
          */
-        virtual VoidPtr GetServiceAsVoidPtr(const Container& container) = 0;
+        virtual bool GetDependencies(std::vector<TypeId>& dependencies) const { return false; }
     };
 }
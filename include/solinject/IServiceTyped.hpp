@@ -27,11 +27,18 @@
 
 namespace sol::di::impl
 {
-    /// DI service interface
-    template <class T>
-    class IServiceTyped : public virtual IService
+    /**
+     * @brief DI service interface
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam T service type
+     */
+    template <class TThreadingPolicy, class T>
+    class IServiceTyped : public virtual IService<TThreadingPolicy>
     {
     public:
+        /// @copydoc sol::di::impl::IService::Container
+        using Container = typename IService<TThreadingPolicy>::Container;
+
         /// Pointer to an instance of a service
         using ServicePtr = typename std::shared_ptr<T>;
 
@@ -49,8 +56,17 @@ namespace sol::di::impl
          * @returns pointer to a service instance
          */
         virtual ServicePtr GetService(const Container& container) = 0;
+
+        /**
+         * @brief Resolves the service by reference
+         * @param[in] container DI container
+         * @returns pointer to the service instance, owned by the DI
+         * service, or `nullptr` if the DI service doesn't own
+         * a single instance
+         */
+        virtual T* BorrowService(const Container& container) = 0;
     };
 
-    template <class T>
-    IServiceTyped<T>::~IServiceTyped() {}
+    template <class TThreadingPolicy, class T>
+    IServiceTyped<TThreadingPolicy, T>::~IServiceTyped() {}
 }
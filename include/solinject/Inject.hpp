@@ -0,0 +1,297 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Utils.hpp"
+#include "TypeId.hpp"
+#include "IService.hpp"
+#include "ExpandedArgs.hpp"
+#include "ResolutionCache.hpp"
+#include "exceptions/ServiceNotRegisteredException.hpp"
+
+namespace sol::di
+{
+    /**
+     * @brief List of the services, which are injected
+     * into a service constructor
+     *
+     * It's passed to the registration methods of @ref Container
+     * instead of a factory function. The constructor signature is
+     * checked at compile time.
+     *
+     * @tparam TDependencies types of the injected services
+     * @headerfile Inject.hpp solinject.hpp
+     */
+    template <class...TDependencies>
+    struct Inject
+    {
+    };
+}
+
+namespace sol::di::impl
+{
+    template <class T, class TThreadingPolicy>
+    class UnownedServiceHandle;
+
+    /**
+     * @brief Factory function, which constructs a service
+     * from its dependencies
+     *
+     * All the dependencies are resolved at once (see
+     * @ref BasicContainer::GetRequiredServices()) and passed to the
+     * implementation constructor as @ref std::shared_ptr arguments.
+     *
+     * The instances are allocated the same way as by @ref FACTORY().
+     * Factories of scoped services, which are explicitly registered
+     * to allocate from the arena, allocate the instances from the
+     * scope's memory arena instead (see @ref BasicContainer::AllocateShared()).
+     * Such instances must not outlive the scope.
+     *
+     * When the container is frozen, the factory compiles a resolution
+     * plan for the container's registrations: a handle (see
+     * @ref ServiceHandle) for each dependency. Resolving the service
+     * from the frozen container, or from a frozen scope, which doesn't
+     * have its own registrations, executes the plan and doesn't search
+     * the registered services. Frozen containers with other registrations
+     * compile plans of their own. Dependencies, which are registered
+     * with @ref Inject too, execute their own plans, so a whole
+     * dependency tree is resolved without any lookups.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TImplementation type of the service implementation
+     * @tparam TDependencies types of the injected services
+     */
+    template <class TThreadingPolicy, class TImplementation, class...TDependencies>
+    class InjectFactory
+    {
+        static_assert(
+            std::is_constructible_v<TImplementation, std::shared_ptr<TDependencies>...>,
+            "The service implementation must be constructible from the injected services"
+        );
+    public:
+        /**
+         * @brief Constructor
+         * @param allocatesFromArena `true` if the instances should be
+         * allocated from the memory arena of the scope they are
+         * resolved from, i.e. the service is a scoped service
+         */
+        explicit InjectFactory(bool allocatesFromArena = false) : m_AllocatesFromArena(allocatesFromArena) {}
+
+        /**
+         * @brief Copy constructor
+         *
+         * The resolution plan is not copied.
+         */
+        InjectFactory(const InjectFactory& other) : InjectFactory(other.m_AllocatesFromArena) {}
+
+        /**
+         * @brief Move constructor
+         *
+         * The resolution plan is not moved.
+         */
+        InjectFactory(InjectFactory&& other) noexcept : InjectFactory(other.m_AllocatesFromArena) {}
+
+        /// Copy-assignment operator (deleted)
+        InjectFactory& operator=(const InjectFactory&) = delete;
+
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /**
+         * @brief Creates an instance of the service
+         * @param[in] container DI container
+         * @returns pointer to the created instance
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         */
+        std::shared_ptr<TImplementation> operator()(const Container& container) const
+        {
+            auto construct = [this, &container](auto&&...dependencies)
+            {
+                if (m_AllocatesFromArena)
+                    return container.template AllocateShared<TImplementation>(
+                        std::forward<decltype(dependencies)>(dependencies)...);
+
+                return MakeShared<TImplementation>(std::forward<decltype(dependencies)>(dependencies)...);
+            };
+
+            if constexpr (sizeof...(TDependencies) == 0)
+            {
+                return construct();
+            }
+            else
+            {
+                if (const ResolutionPlan* plan = FindPlan(container.GetResolutionPlanKey()); plan != nullptr)
+                {
+                    return std::apply(
+                        [&construct, &container](const auto&...handles)
+                        {
+                            return construct(handles.Get(container)...);
+                        },
+                        plan->handles
+                    );
+                }
+
+                return std::apply(construct, container.template GetRequiredServices<TDependencies...>());
+            }
+        }
+
+        /**
+         * @brief Compiles the resolution plan for
+         * the registrations of a frozen container
+         *
+         * If a plan for the container's registrations is already
+         * compiled (e.g. by a scope without its own registrations),
+         * it's reused. If a dependency is not registered, the plan
+         * is not compiled, and resolving the service throws as usual.
+         *
+         * @param[in] container the frozen DI container
+         */
+        void CompilePlan(const Container& container)
+        {
+            if constexpr (sizeof...(TDependencies) != 0)
+            {
+                ContainerGeneration key = container.GetResolutionPlanKey();
+
+                Lock lock(m_Mutex);
+
+                if (key == 0 || FindPlan(key) != nullptr || m_PlanCount == MaxPlanCount)
+                    return;
+
+                std::unique_ptr<ResolutionPlan> plan;
+
+                try
+                {
+                    plan.reset(new ResolutionPlan {
+                        key,
+                        std::tuple<UnownedServiceHandle<TDependencies, TThreadingPolicy>...>(
+                            container.template GetHandle<TDependencies>()...),
+                        m_Plans.load(std::memory_order_relaxed)
+                    });
+                }
+                catch (const exc::ServiceNotRegisteredException&)
+                {
+                    return;
+                }
+
+                m_Plans.store(plan.release(), std::memory_order_release);
+                m_PlanCount++;
+            }
+        }
+
+        /**
+         * @brief Gets the types of the injected services
+         * @param[out] dependencies vector, which the type IDs are added to
+         */
+        void GetDependencies(std::vector<TypeId>& dependencies) const
+        {
+            (dependencies.push_back(GetTypeId<TDependencies>()), ...);
+        }
+
+        /// Destructor
+        ~InjectFactory()
+        {
+            const ResolutionPlan* plan = m_Plans.load(std::memory_order_relaxed);
+
+            while (plan != nullptr)
+                delete std::exchange(plan, plan->next);
+        }
+
+    private:
+        /**
+         * @brief Resolution plan
+         *
+         * The handles don't own the DI services, so the DI services
+         * of circular registrations don't own each other. The plan is
+         * only executed by containers with the same registrations as the
+         * container it was compiled for, and they keep the DI services alive.
+         */
+        struct ResolutionPlan
+        {
+            /**
+             * @brief Key of the registrations the plan was compiled
+             * for (see @ref BasicContainer::GetResolutionPlanKey())
+             */
+            ContainerGeneration key;
+
+            /// Handles of the dependencies
+            std::tuple<UnownedServiceHandle<TDependencies, TThreadingPolicy>...> handles;
+
+            /// The previously compiled plan or `nullptr`
+            const ResolutionPlan* next;
+        };
+
+        /**
+         * @brief Maximum number of compiled plans
+         *
+         * Plans are kept until the factory is destroyed, because
+         * other threads may be executing them, so containers with
+         * different registrations, frozen one after another,
+         * don't compile new plans forever.
+         */
+        static constexpr size_t MaxPlanCount = 8;
+
+        /// Mutex type
+        using Mutex = DiscardableMutex<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = DiscardableLock<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Field, indicating if the instances are allocated from the scope's memory arena
+        bool m_AllocatesFromArena;
+
+        /// Mutex, which guards the plan compilation
+        Mutex m_Mutex;
+
+        /// Number of the compiled plans
+        size_t m_PlanCount = 0;
+
+        /**
+         * @brief Pointer to the last compiled resolution plan
+         * or `nullptr` if no plans are compiled
+         */
+        std::atomic<const ResolutionPlan*> m_Plans { nullptr };
+
+        /**
+         * @brief Finds the resolution plan for registrations
+         * @param key key of the registrations or `0`
+         * @returns pointer to the plan or `nullptr` if it's not compiled
+         */
+        const ResolutionPlan* FindPlan(ContainerGeneration key) const
+        {
+            if (key == 0)
+                return nullptr;
+
+            for (const ResolutionPlan* plan = m_Plans.load(std::memory_order_acquire); plan != nullptr; plan = plan->next)
+                if (plan->key == key)
+                    return plan;
+
+            return nullptr;
+        }
+    };
+}
@@ -0,0 +1,96 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include "ResolutionCache.hpp"
+#include "RegisteredService.hpp"
+#include "ResolutionContext.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Inline cache of a service lookup at a single call site
+     *
+     * The cache remembers the last container, its generation and the
+     * DI service, found for the service type. While the container's
+     * registrations don't change, the lookup is skipped, and the
+     * service is resolved from the cached DI service, so its lifetime
+     * is respected. Otherwise the DI service is looked up as usual.
+     *
+     * The cache is not thread-safe, so each call site
+     * should keep a `thread_local` instance.
+     *
+     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @see SOLINJECT_INLINE_CACHE
+     */
+    template <class T, class TThreadingPolicy>
+    class InlineCache
+    {
+    public:
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /**
+         * @brief Resolves a service
+         * @tparam nothrow value, indicating if the method should throw
+         * exception if the service is not registered
+         * @param context the resolution context
+         * @returns pointer to an instance of the service or `nullptr`
+         * if the service is not registered and @p nothrow is `true`
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         */
+        template <bool nothrow>
+        std::shared_ptr<T> Resolve(const BasicResolutionContext<TThreadingPolicy>& context)
+        {
+            const Container* container = &context.GetContainer();
+
+            if (m_Container != container || m_Generation != context.m_Generation)
+            {
+                m_DIService = context.m_Services->template FindDIService<T, nothrow>();
+                m_Container = container;
+                m_Generation = context.m_Generation;
+            }
+
+            if (m_DIService == nullptr)
+                return nullptr;
+
+            return m_DIService->template Resolve<T>(*container);
+        }
+
+    private:
+        /// The container the DI service was looked up in
+        const Container* m_Container = nullptr;
+
+        /// The container's generation
+        ContainerGeneration m_Generation = 0;
+
+        /**
+         * @brief The DI service or `nullptr` if the service is not registered
+         *
+         * The DI service is owned by the container's registered services
+         * of @ref m_Generation, so it's valid while the generation matches.
+         */
+        const RegisteredService<TThreadingPolicy>* m_DIService = nullptr;
+    };
+}
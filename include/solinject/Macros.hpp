@@ -22,6 +22,21 @@
 
 #pragma once
 
+/**
+ * @brief Resolves a service through an inline cache,
+ * which is owned by the macro expansion site
+ * @param class_ service type
+ * @param nothrow `true` if the service is optional
+ * @warning This macro is intended for internal use only.
+ * @see sol::di::impl::InlineCache
+ */
+#define SOLINJECT_RESOLVE_CACHED(class_, nothrow) \
+    ([&c]() \
+    { \
+        thread_local sol::di::impl::InlineCache<class_, typename std::decay_t<decltype(c)>::ThreadingPolicy> cache; \
+        return cache.template Resolve<nothrow>(c); \
+    }())
+
 /**
  * @brief Injects a required service from a DI container
  * @param class_ service type
@@ -41,9 +56,16 @@
  * - @ref RegisterScopedService()
  * - @ref RegisterScopedInterface()
  *
+ * If @ref SOLINJECT_INLINE_CACHE is defined, each expansion
+ * of the macro caches the service lookup.
+ *
  * @see sol::di::exc::ServiceNotRegisteredException
  */
-#define FROM_DI(class_) (c.template GetRequiredService<class_>())
+#ifdef SOLINJECT_INLINE_CACHE
+    #define FROM_DI(class_) SOLINJECT_RESOLVE_CACHED(class_, false)
+#else
+    #define FROM_DI(class_) (c.template GetRequiredService<class_>())
+#endif
 
 /**
  * @brief Injects an optional service from a DI container
@@ -67,8 +89,15 @@
  * - @ref RegisterSharedInterface()
  * - @ref RegisterScopedService()
  * - @ref RegisterScopedInterface()
+ *
+ * If @ref SOLINJECT_INLINE_CACHE is defined, each expansion
+ * of the macro caches the service lookup.
  */
-#define FROM_DI_OPTIONAL(class_) (c.template GetService<class_>())
+#ifdef SOLINJECT_INLINE_CACHE
+    #define FROM_DI_OPTIONAL(class_) SOLINJECT_RESOLVE_CACHED(class_, true)
+#else
+    #define FROM_DI_OPTIONAL(class_) (c.template GetService<class_>())
+#endif
 
 /**
  * @brief Injects multiple instances of a service from a DI container
@@ -91,15 +120,65 @@
  */
 #define FROM_DI_MULTIPLE(class_) (c.template GetServices<class_>())
 
+/**
+ * @brief Injects several required services from a DI container at once
+ * @param ... services types
+ *
+ * The services are resolved with a single lookup of the registered
+ * services and injected as separate @ref std::shared_ptr arguments,
+ * in the order they are listed. If any of the services is not
+ * registered, an exception will be thrown.
+ *
+ * This macro is intended for use as service constructor arguments
+ * for the following macros:
+ * - @ref RegisterSingletonService()
+ * - @ref RegisterSingletonInterface()
+ * - @ref RegisterTransientService()
+ * - @ref RegisterTransientInterface()
+ * - @ref RegisterSharedService()
+ * - @ref RegisterSharedInterface()
+ * - @ref RegisterScopedService()
+ * - @ref RegisterScopedInterface()
+ *
+ * @see sol::di::BasicContainer::GetRequiredServices()
+ * @see sol::di::exc::ServiceNotRegisteredException
+ */
+#define FROM_DI_ALL(...) \
+    (sol::di::impl::ExpandArgs(c.template GetRequiredServices<__VA_ARGS__>()))
+
 /**
  * @brief Service factory
  * @param class_ the service type
  * @param ... the service constructor parameters
  */
 #define FACTORY(class_, ...) \
-    [](const sol::di::Container& c) \
+    [](const auto& container) \
+    { \
+        const sol::di::BasicResolutionContext c(container); \
+        return sol::di::impl::MakeShared<class_>(__VA_ARGS__); \
+    }
+
+/**
+ * @brief Service factory, which allocates the service
+ * from the container's memory resource
+ * @param class_ the service type
+ * @param ... the service constructor parameters
+ *
+ * When the service is resolved from a scope, it's allocated
+ * from the scope's memory arena, which is released in bulk
+ * when the scope is destroyed.
+ *
+ * @warning The service must not outlive the scope, so this factory
+ * should be used only for scoped services and transient services,
+ * which are not injected into singleton or shared services.
+ *
+ * @see sol::di::BasicContainer::AllocateShared()
+ */
+#define ARENA_FACTORY(class_, ...) \
+    [](const auto& container) \
     { \
-        return std::make_shared<class_>(__VA_ARGS__); \
+        const sol::di::BasicResolutionContext c(container); \
+        return c.template AllocateShared<class_>(__VA_ARGS__); \
     }
 
 /**
@@ -114,6 +193,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterSingletonService(container, class_, ...) \
     (container).template RegisterSingletonService<class_>(FACTORY(class_, __VA_ARGS__))
@@ -132,6 +212,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterSingletonInterface(container, interface_, implementation, ...) \
     (container).template RegisterSingletonService<interface_>(FACTORY(implementation, __VA_ARGS__))
@@ -148,6 +229,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterTransientService(container, class_, ...) \
     (container).template RegisterTransientService<class_>(FACTORY(class_, __VA_ARGS__))
@@ -166,6 +248,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterTransientInterface(container, interface_, implementation, ...) \
     (container).template RegisterTransientService<interface_>(FACTORY(implementation, __VA_ARGS__))
@@ -185,6 +268,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterSharedService(container, class_, ...) \
     (container).template RegisterSharedService<class_>(FACTORY(class_, __VA_ARGS__))
@@ -206,6 +290,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterSharedInterface(container, interface_, implementation, ...) \
     (container).template RegisterSharedService<interface_>(FACTORY(implementation, __VA_ARGS__))
@@ -222,6 +307,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterScopedService(container, class_, ...) \
     (container).template RegisterScopedService<class_>(FACTORY(class_, __VA_ARGS__))
@@ -240,6 +326,7 @@
  * @see FROM_DI
  * @see FROM_DI_OPTIONAL
  * @see FROM_DI_MULTIPLE
+ * @see FROM_DI_ALL
  */
 #define RegisterScopedInterface(container, interface_, implementation, ...) \
     (container).template RegisterScopedService<interface_>(FACTORY(implementation, __VA_ARGS__))
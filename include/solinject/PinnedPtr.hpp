@@ -0,0 +1,163 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace sol::di::impl
+{
+    template <class T>
+    class PinnedPtr;
+
+    /**
+     * @brief Base for copy-on-write collections, which
+     * can be pinned by @ref PinnedPtr
+     *
+     * A pinned collection may be read by other threads or scopes
+     * without locking, so it has to be copied before modification.
+     */
+    class Pinnable
+    {
+    public:
+        /**
+         * @brief Tells if the collection is pinned
+         *
+         * The check synchronizes with unpinning, so if the collection
+         * is not pinned, all previous reads of it have completed.
+         *
+         * @returns `true` if the collection is pinned, `false` otherwise
+         */
+        bool IsPinned() const
+        {
+            return m_PinCount.load(std::memory_order_acquire) != 0;
+        }
+
+    protected:
+        /// Default constructor
+        Pinnable() {}
+
+        /// Copy constructor. Copies are not pinned.
+        Pinnable(const Pinnable&) {}
+
+        /// Copy-assignment operator. Doesn't change the pin count.
+        Pinnable& operator=(const Pinnable&) { return *this; }
+
+    private:
+        template <class T>
+        friend class PinnedPtr;
+
+        /// Number of @ref PinnedPtr instances, which point to the collection
+        mutable std::atomic<size_t> m_PinCount = 0;
+    };
+
+    /**
+     * @brief Pointer to an immutable @ref Pinnable collection
+     *
+     * While at least one such pointer exists, the collection
+     * is pinned and must not be modified.
+     *
+     * @tparam T collection type
+     */
+    template <class T>
+    class PinnedPtr
+    {
+    public:
+        /// Default constructor
+        PinnedPtr() {}
+
+        /**
+         * @brief Constructor, which pins the collection
+         * @param ptr pointer to the collection
+         */
+        PinnedPtr(std::shared_ptr<const T> ptr) : m_Ptr(std::move(ptr))
+        {
+            if (m_Ptr != nullptr)
+                m_Ptr->m_PinCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Copy constructor
+        PinnedPtr(const PinnedPtr& other) : PinnedPtr(other.m_Ptr)
+        {
+        }
+
+        /// Move constructor
+        PinnedPtr(PinnedPtr&& other) noexcept : m_Ptr(std::move(other.m_Ptr))
+        {
+        }
+
+        /// Assignment operator
+        PinnedPtr& operator=(PinnedPtr other) noexcept
+        {
+            std::swap(m_Ptr, other.m_Ptr);
+            return *this;
+        }
+
+        /// Destructor, which unpins the collection
+        ~PinnedPtr()
+        {
+            if (m_Ptr != nullptr)
+                m_Ptr->m_PinCount.fetch_sub(1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Gets the raw pointer
+         * @returns the raw pointer
+         */
+        const T* get() const { return m_Ptr.get(); }
+
+        /// Dereferences the pointer
+        const T& operator*() const { return *m_Ptr; }
+
+        /// Dereferences the pointer
+        const T* operator->() const { return m_Ptr.get(); }
+
+        /// Tells if the pointer is not null
+        explicit operator bool() const { return m_Ptr != nullptr; }
+
+    private:
+        /// Pointer to the collection
+        std::shared_ptr<const T> m_Ptr;
+    };
+
+    /**
+     * @brief Prepares a copy-on-write collection for modification
+     *
+     * If the collection is pinned, it's replaced by its copy,
+     * so the pinned collection stays immutable.
+     *
+     * @warning The caller must prevent concurrent pinning,
+     * e.g. by locking the owning container's mutex
+     * @tparam T collection type
+     * @param ptr pointer to the collection
+     * @returns the collection, which may be modified
+     */
+    template <class T>
+    T& CopyIfPinned(std::shared_ptr<T>& ptr)
+    {
+        if (ptr->IsPinned())
+            ptr = std::make_shared<T>(*ptr);
+
+        return *ptr;
+    }
+}
@@ -0,0 +1,151 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <utility>
+#include "solinject/Defines.hpp"
+#include "TypeId.hpp"
+#include "IService.hpp"
+#include "IServiceTyped.hpp"
+#include "solinject/exceptions/ServiceNotBorrowableException.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief DI service, registered for a service type
+     *
+     * The DI service is stored together with its resolver for
+     * the type it's registered for, so resolving the service
+     * is a single virtual call without any casts.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
+    class RegisteredService
+    {
+    public:
+        /// Pointer to a DI service instance
+        using DIServicePtr = std::shared_ptr<IService<TThreadingPolicy>>;
+
+        /// DI container
+        using Container = typename IService<TThreadingPolicy>::Container;
+
+        /**
+         * @brief Resolver of the DI service
+         * @tparam T the type the service is registered for
+         */
+        template <class T>
+        using Resolver = IServiceTyped<TThreadingPolicy, T>;
+
+        /// Default constructor
+        RegisteredService() {}
+
+        /**
+         * @brief Constructor
+         * @param diService pointer to the DI service
+         * @param typeId ID of the type the service is registered for
+         */
+        RegisteredService(DIServicePtr diService, TypeId typeId) :
+            m_DIService(std::move(diService)),
+            m_Resolver(m_DIService->GetResolver(typeId))
+        {
+            solinject_req_assert(m_Resolver != nullptr && "The service is resolvable as the type it's registered for");
+        }
+
+        /**
+         * @brief Creates a @ref RegisteredService
+         * @tparam T the type the service is registered for
+         * @tparam TDIService DI service type
+         * @param diService pointer to the DI service
+         * @returns the created @ref RegisteredService
+         */
+        template <class T, class TDIService>
+        static RegisteredService Create(std::shared_ptr<TDIService> diService)
+        {
+            RegisteredService result;
+
+            result.m_Resolver = static_cast<Resolver<T>*>(diService.get());
+            result.m_DIService = std::move(diService);
+
+            return result;
+        }
+
+        /**
+         * @brief Resolves the service
+         * @tparam T the type the service is registered for
+         * @param[in] container DI container
+         * @returns pointer to an instance of the service
+         */
+        template <class T>
+        std::shared_ptr<T> Resolve(const Container& container) const
+        {
+            solinject_req_assert(m_Resolver != nullptr);
+
+            return static_cast<Resolver<T>*>(m_Resolver)->GetService(container);
+        }
+
+        /**
+         * @brief Resolves the service by reference
+         * @tparam T the type the service is registered for
+         * @param[in] container DI container
+         * @returns reference to the service instance, owned by the DI service
+         * @throws sol::di::exc::ServiceNotBorrowableException
+         */
+        template <class T>
+        T& Borrow(const Container& container) const
+        {
+            solinject_req_assert(m_Resolver != nullptr);
+
+            T* instance = static_cast<Resolver<T>*>(m_Resolver)->BorrowService(container);
+
+            if (instance == nullptr)
+                throw exc::ServiceNotBorrowableException(typeid(T));
+
+            return *instance;
+        }
+
+        /**
+         * @brief Gets the resolver of the DI service
+         * @tparam T the type the service is registered for
+         * @returns the DI service's @ref IServiceTyped base
+         */
+        template <class T>
+        Resolver<T>* GetResolver() const
+        {
+            return static_cast<Resolver<T>*>(m_Resolver);
+        }
+
+        /**
+         * @brief Gets the DI service
+         * @returns pointer to the DI service
+         */
+        const DIServicePtr& DIService() const { return m_DIService; }
+
+    private:
+        /// Pointer to the DI service
+        DIServicePtr m_DIService;
+
+        /// The DI service's @ref IServiceTyped base
+        void* m_Resolver = nullptr;
+    };
+}
@@ -22,64 +22,132 @@
 
 #pragma once
 
-#include <map>
 #include <vector>
 #include <algorithm>
 #include <memory>
 #include <typeinfo>
 #include <typeindex>
+#include <atomic>
 
 #include "solinject/Defines.hpp"
+#include "TypeId.hpp"
+#include "PinnedPtr.hpp"
 #include "IService.hpp"
 #include "IServiceTyped.hpp"
+#include "RegisteredService.hpp"
 #include "SingletonService.hpp"
 #include "TransientService.hpp"
 #include "SharedService.hpp"
 #include "ScopedService.hpp"
+#include "ValueService.hpp"
+#include "ScopedServiceSlots.hpp"
+#include "ScopeArena.hpp"
 #include "solinject/exceptions/ServiceNotRegisteredException.hpp"
 #include "solinject/Utils.hpp"
 
 namespace sol::di::impl
 {
-    /// Registered DI services collection
-    class RegisteredServices
+    /**
+     * @brief Registered DI services collection
+     *
+     * A collection may have a parent collection. Services, registered
+     * in the parent collection, are resolvable from the child collection
+     * and come before the child collection's own services. This lets
+     * scopes share their parent's services without copying them.
+     *
+     * A scope's collection also has scoped service slots, which come
+     * after the parent collection's services and before the scope's
+     * own services.
+     *
+     * A scope's collection owns the scope's memory arena, which is
+     * shared with the collection's copies and is destroyed after
+     * the services.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
+    class RegisteredServices : public Pinnable
     {
     public:
         /**
-         * @copydoc IServiceTyped<T>::Factory
+         * @copydoc IServiceTyped::Factory
          * @tparam T service type
          */
         template <class T>
-        using Factory = typename IServiceTyped<T>::Factory;
+        using Factory = typename IServiceTyped<TThreadingPolicy, T>::Factory;
 
         /**
-         * @copydoc IServiceTyped<T>::ServicePtr
+         * @copydoc IServiceTyped::ServicePtr
          * @tparam T service type
          */
         template <class T>
-        using ServicePtr = typename IServiceTyped<T>::ServicePtr;
+        using ServicePtr = typename IServiceTyped<TThreadingPolicy, T>::ServicePtr;
+
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /// DI service, registered for a service type
+        using RegisteredService = impl::RegisteredService<TThreadingPolicy>;
+
+        /// Scoped DI services of a single scope
+        using ScopedServiceSlots = impl::ScopedServiceSlots<TThreadingPolicy>;
+
+        /// Scoped DI service builders collection
+        using ScopedServiceBuilders = impl::ScopedServiceBuilders<TThreadingPolicy>;
+
+        /// Memory arena of a scope
+        using ScopeArena = impl::ScopeArena<TThreadingPolicy>;
 
         /// Pointer to a DI service instance
-        using DIServicePtr = std::shared_ptr<IService>;
+        using DIServicePtr = std::shared_ptr<IService<TThreadingPolicy>>;
+
+        /// DI services, registered for a single service type
+        using DIServicesVector = std::vector<RegisteredService>;
 
-        /// Map of registered DI services
-        using RegisteredServicesMap = std::map<std::type_index, std::vector<DIServicePtr>>;
+        /// Registered DI services, indexed by service type ID
+        using RegisteredServicesArray = std::vector<DIServicesVector>;
+
+        /// Pointer to an immutable @ref RegisteredServices instance
+        using ConstPtr = PinnedPtr<RegisteredServices>;
+
+        /// Pointer to scoped service slots
+        using ScopedServiceSlotsPtr = std::shared_ptr<ScopedServiceSlots>;
+
+        /// Pointer to a scope's memory arena
+        using ScopeArenaPtr = std::shared_ptr<ScopeArena>;
+
+        /// @copydoc ScopedServiceSlots::SlotIndicesVector
+        using SlotIndicesVector = typename ScopedServiceSlots::SlotIndicesVector;
 
         /// Default constructor
         RegisteredServices() {}
 
         /**
          * @brief Constructor
-         * @param services map of DI services
+         * @param parent pointer to the parent collection
+         * @param scopedSlots pointer to the scoped service slots
+         * @param arena pointer to the scope's memory arena
          */
-        RegisteredServices(RegisteredServicesMap services) :
-            m_RegisteredServices(std::move(services))
+        RegisteredServices(ConstPtr parent, ScopedServiceSlotsPtr scopedSlots, ScopeArenaPtr arena) :
+            m_Arena(std::move(arena)),
+            m_Parent(std::move(parent)),
+            m_ScopedSlots(std::move(scopedSlots))
         {
         }
 
-        /// Copy constructor
+        /**
+         * @brief Copy constructor
+         *
+         * The copy shares the scoped service slots and the memory arena
+         * with the original, so scoped services stay the same within a scope.
+         */
         RegisteredServices(const RegisteredServices& other) :
-            m_RegisteredServices(other.m_RegisteredServices)
+            Pinnable(),
+            m_Arena(other.m_Arena),
+            m_RegisteredServices(other.m_RegisteredServices),
+            m_OwnServiceCount(other.m_OwnServiceCount),
+            m_Parent(other.m_Parent),
+            m_ScopedSlots(other.m_ScopedSlots)
         {
         }
 
@@ -109,66 +177,70 @@ namespace sol::di::impl
             using std::swap;
 
             swap(a.m_RegisteredServices, b.m_RegisteredServices);
+            swap(a.m_OwnServiceCount, b.m_OwnServiceCount);
+            swap(a.m_Parent, b.m_Parent);
+            swap(a.m_ScopedSlots, b.m_ScopedSlots);
+            swap(a.m_Arena, b.m_Arena);
         }
 
         /**
-         * @brief Merges other @ref RegisteredServices instance
-         * into this instance
-         * @param other other @ref RegisteredServices instance
+         * @brief Registers a service with singleton lifetime
+         * @param factory factory function
+         * @tparam T service type
+         * @tparam TFactory factory function type
          */
-        void Merge(RegisteredServices other)
+        template<class T, class TFactory>
+        void RegisterSingletonService(TFactory factory)
         {
-            for (auto& pair : other.m_RegisteredServices)
-            {
-                auto& source = pair.second;
-                auto& destination = m_RegisteredServices[pair.first];
-
-                impl::ConcatenateVectors(destination, std::move(source));
-            }
+            RegisterServiceInternal<T, SingletonService<TThreadingPolicy, T, TFactory>>(std::move(factory));
         }
 
         /**
          * @brief Registers a service with singleton lifetime
-         * @param factory factory function
+         * @param instance pointer to an instance of the service
          * @tparam T service type
          */
         template<class T>
-        void RegisterSingletonService(Factory<T> factory)
+        void RegisterSingletonService(ServicePtr<T> instance)
         {
-            RegisterServiceInternal<T, SingletonService<T>>(factory);
+            solinject_req_assert(instance != nullptr);
+
+            RegisterServiceInternal<T, SingletonService<TThreadingPolicy, T>>(instance);
         }
 
         /**
-         * @brief Registers a service with singleton lifetime
-         * @param instance pointer to an instance of the service
+         * @brief Registers a value, which is stored inline
+         * @param value the value
          * @tparam T service type
          */
         template<class T>
-        void RegisterSingletonService(ServicePtr<T> instance)
+        void RegisterValue(T value)
         {
-            RegisterServiceInternal<T, SingletonService<T>>(instance);
+            RegisterServiceInternal<T, ValueService<TThreadingPolicy, T>>(std::move(value));
         }
 
         /**
          * @brief Registers a service with transient lifetime
          * @param factory factory function
          * @tparam T service type
+         * @tparam TFactory factory function type
          */
-        template<class T>
-        void RegisterTransientService(Factory<T> factory)
+        template<class T, class TFactory>
+        void RegisterTransientService(TFactory factory)
         {
-            RegisterServiceInternal<T, TransientService<T>>(factory);
+            RegisterServiceInternal<T, TransientService<TThreadingPolicy, T, TFactory>>(std::move(factory));
         }
 
         /**
          * @brief Registers a service with shared lifetime
          * @param factory factory function
          * @tparam T service type
+         * @tparam TFactory factory function type
          */
-        template<class T>
-        void RegisterSharedService(Factory<T> factory)
+        template<class T, class TFactory>
+        void RegisterSharedService(TFactory factory)
         {
-            RegisterServiceInternal<T, SharedService<T>>(factory);
+            RegisterServiceInternal<T, SharedService<TThreadingPolicy, T, TFactory>>(std::move(factory));
         }
 
         /**
@@ -180,7 +252,19 @@ namespace sol::di::impl
          */
         void RegisterService(std::type_index type, DIServicePtr diService)
         {
-            RegisterServiceInternal(type, diService);
+            RegisterService(GetTypeId(type), diService);
+        }
+
+        /**
+         * @brief Registers a service
+         * @param typeId service type ID
+         * @param diService pointer to a DI service instance
+         */
+        void RegisterService(TypeId typeId, DIServicePtr diService)
+        {
+            solinject_req_assert(diService != nullptr);
+
+            RegisterServiceInternal(typeId, RegisteredService(std::move(diService), typeId));
         }
 
         /**
@@ -219,90 +303,364 @@ namespace sol::di::impl
         template <class T>
         std::vector<ServicePtr<T>> GetServices(const Container& container) const
         {
-            using namespace std::string_literals;
+            std::vector<ServicePtr<T>> result;
+            result.reserve(CountDIServices<T>());
 
-            auto serviceIt = m_RegisteredServices.find(std::type_index(typeid(T)));
+            ForEachService<T>(container, [&result](ServicePtr<T> service)
+            {
+                result.push_back(std::move(service));
+            });
 
-            if (serviceIt == m_RegisteredServices.end())
-                return std::vector<ServicePtr<T>>();
+            return result;
+        }
 
-            auto& services = serviceIt->second;
+        /**
+         * @brief Resolves services and invokes a callback for each
+         * of the instances in registration order
+         * @tparam T the service type
+         * @tparam TCallback callback type
+         * @param[in] container DI container
+         * @param callback callback, which accepts a pointer
+         * to a service instance
+         */
+        template <class T, class TCallback>
+        void ForEachService(const Container& container, TCallback&& callback) const
+        {
+            ForEachDIService<T>([&callback, &container](const RegisteredService& diService)
+            {
+                callback(diService.template Resolve<T>(container));
+            });
+        }
 
-            std::vector<ServicePtr<T>> result;
-            result.reserve(services.size());
-
-            std::transform(
-                services.begin(),
-                services.end(),
-                std::back_inserter(result),
-                [this, &container](auto& diService)
-                {
-                    return GetServiceInstance<T>(diService, container);
-                }
-            );
+        /**
+         * @brief Finds the last DI service, registered for a service type
+         *
+         * The collection's own services are searched first,
+         * then its scoped services, then the parent collection's services.
+         *
+         * @tparam T service type
+         * @tparam nothrow value, indicating if the method should throw
+         * exception if the service is not registered
+         * @returns pointer to the DI service or `nullptr`
+         * if the service is not registered
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         */
+        template <class T, bool nothrow>
+        const RegisteredService* FindDIService() const
+        {
+            if (const RegisteredService* diService = FindDIService(GetTypeId<T>()); diService != nullptr)
+                return diService;
 
-            return result;
+            if constexpr (nothrow)
+            {
+                return nullptr;
+            }
+            else
+            {
+                solinject_assert(false && "The service is registered");
+                throw exc::ServiceNotRegisteredException(typeid(T));
+            }
         }
-    private:
-        /// Registered services
-        RegisteredServicesMap m_RegisteredServices;
 
         /**
-         * @brief Registers a service
-         * @param type service type
-         * @param diService pointer to a DI service instance
+         * @brief Finds the last DI service, registered for a service type
+         * @param typeId service type ID
+         * @returns pointer to the DI service or `nullptr`
+         * if the service is not registered
          */
-        void RegisterServiceInternal(std::type_index type, DIServicePtr diService)
+        const RegisteredService* FindDIService(TypeId typeId) const
         {
-            m_RegisteredServices[type].push_back(diService);
+            for (auto services = this; services != nullptr; services = services->m_Parent.get())
+                if (const RegisteredService* diService = services->FindOwnDIService(typeId); diService != nullptr)
+                    return diService;
+
+            return nullptr;
         }
 
         /**
-         * @brief Registers a service
-         * @tparam TService service type
-         * @tparam TDISevice DI service type
-         * @param factory factory function
+         * @brief Invokes a callback for each DI service,
+         * registered for a service type, in registration order
+         * @tparam T service type
+         * @tparam TCallback callback type
+         * @param callback callback, which accepts a `const` reference
+         * to a @ref RegisteredService
          */
-        template <class TService, class TDIService>
-        void RegisterServiceInternal(Factory<TService> factory)
+        template <class T, class TCallback>
+        void ForEachDIService(TCallback&& callback) const
         {
-            RegisterServiceInternal(
-                std::type_index(typeid(TService)),
-                std::make_shared<TDIService>(factory)
-            );
+            TypeId typeId = GetTypeId<T>();
+
+            if (m_Parent)
+                m_Parent->template ForEachDIService<T>(callback);
+
+            if (const SlotIndicesVector* slotIndices = FindScopedSlotIndices(typeId); slotIndices != nullptr)
+                for (size_t slotIndex : *slotIndices)
+                    callback(m_ScopedSlots->GetDIService(slotIndex));
+
+            const DIServicesVector* diServices = FindOwnDIServices(typeId);
+
+            if (diServices != nullptr)
+                for (const auto& diService : *diServices)
+                    callback(diService);
         }
 
         /**
-         * @brief Registers a service
-         * @tparam TService service type
-         * @tparam TDISevice DI service type
-         * @param instance pointer to an instance of the service
+         * @brief Invokes a callback for each registered DI service,
+         * except the scoped services
+         * @tparam TCallback callback type
+         * @param callback callback, which accepts a `const` reference
+         * to a @ref RegisteredService
          */
-        template <class TService, class TDIService>
-        void RegisterServiceInternal(ServicePtr<TService> instance)
+        template <class TCallback>
+        void ForEachRegisteredService(TCallback&& callback) const
         {
-            solinject_req_assert(instance != nullptr);
+            if (m_Parent)
+                m_Parent->ForEachRegisteredService(callback);
 
-            m_RegisteredServices[std::type_index(typeid(TService))].push_back(std::make_shared<TDIService>(instance));
+            for (const auto& diServices : m_RegisteredServices)
+                for (const auto& diService : diServices)
+                    callback(diService);
         }
 
         /**
-         * @brief Resolves a service from a DI service
+         * @brief Counts DI services, registered for a service type
          * @tparam T service type
-         * @param[in] diServicePtr pointer to an instance of the DI service
-         * @param[in] container DI container
-         * @returns pointer to an instance of the service
+         * @returns number of DI services
          */
         template <class T>
-        ServicePtr<T> GetServiceInstance(const DIServicePtr& diServicePtr, const Container& container) const
+        size_t CountDIServices() const
+        {
+            TypeId typeId = GetTypeId<T>();
+            size_t result = 0;
+
+            for (auto services = this; services != nullptr; services = services->m_Parent.get())
+            {
+                if (const DIServicesVector* diServices = services->FindOwnDIServices(typeId); diServices != nullptr)
+                    result += diServices->size();
+
+                if (const SlotIndicesVector* slotIndices = services->FindScopedSlotIndices(typeId); slotIndices != nullptr)
+                    result += slotIndices->size();
+            }
+
+            return result;
+        }
+
+        /**
+         * @brief Resets a scope's collection for reuse
+         *
+         * The collection's own services are removed and the scoped
+         * service instances are destroyed, but the allocated storage
+         * is kept. The memory arena is released. The collection is detached from its parent
+         * collection until @ref Rebind() is called.
+         *
+         * @warning Must not be called while the collection
+         * may be used by other threads
+         * @returns `true` if the collection was reset, `false` if it's
+         * shared with other scopes and can't be reused
+         */
+        bool TryReset()
+        {
+            if (IsPinned())
+                return false;
+
+            // Copies of the collection share the slots and the arena
+            if ((m_ScopedSlots != nullptr && m_ScopedSlots.use_count() != 1) ||
+                (m_Arena != nullptr && m_Arena.use_count() != 1))
+            {
+                return false;
+            }
+
+            // Synchronizes with the release of the slots and the arena by the other owners
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (m_ScopedSlots != nullptr)
+                m_ScopedSlots->Reset();
+
+            for (auto& diServices : m_RegisteredServices)
+                diServices.clear();
+
+            m_OwnServiceCount = 0;
+
+            if (m_Arena != nullptr)
+                m_Arena->Release();
+
+            m_Parent = ConstPtr();
+
+            return true;
+        }
+
+        /**
+         * @brief Rebinds a scope's collection to the parent collection
+         * and the scoped service builders
+         * @warning Must not be called while the collection
+         * may be used by other threads
+         * @param parent pointer to the parent collection
+         * @param builders pointer to the scoped service builders
+         */
+        void Rebind(ConstPtr parent, typename ScopedServiceBuilders::ConstPtr builders)
+        {
+            m_Parent = std::move(parent);
+
+            if (m_ScopedSlots != nullptr)
+                m_ScopedSlots->Rebind(std::move(builders));
+            else if (!builders->IsEmpty())
+                m_ScopedSlots = std::make_shared<ScopedServiceSlots>(std::move(builders));
+        }
+
+        /**
+         * @brief Finds the slot index of the scoped service, which
+         * is resolved for a service type from this collection, if it's
+         * one of the collection's own scoped services
+         * @param typeId service type ID
+         * @param[out] slotIndex the slot index
+         * @returns `true` if the service is one of the collection's own
+         * scoped services, `false` otherwise
+         */
+        bool FindOwnScopedSlotIndex(TypeId typeId, size_t& slotIndex) const
+        {
+            if (const DIServicesVector* diServices = FindOwnDIServices(typeId);
+                diServices != nullptr && !diServices->empty())
+            {
+                return false;
+            }
+
+            const SlotIndicesVector* slotIndices = FindScopedSlotIndices(typeId);
+
+            if (slotIndices == nullptr || slotIndices->empty())
+                return false;
+
+            slotIndex = slotIndices->back();
+            return true;
+        }
+
+        /**
+         * @brief Tells if services are registered in this
+         * collection itself, not in its parents
+         * @returns `true` if the collection has its own
+         * services, `false` otherwise
+         */
+        bool HasOwnServices() const { return m_OwnServiceCount != 0; }
+
+        /**
+         * @brief Gets the scoped service slots
+         * @returns pointer to the scoped service slots or `nullptr`
+         * if the collection doesn't have any
+         */
+        ScopedServiceSlots* GetScopedSlots() const { return m_ScopedSlots.get(); }
+
+        /**
+         * @brief Gets the scope's memory arena
+         * @returns pointer to the memory arena or `nullptr`
+         * if the collection doesn't belong to a scope
+         */
+        ScopeArena* GetArena() const { return m_Arena.get(); }
+
+    private:
+        /**
+         * @brief Pointer to the scope's memory arena
+         *
+         * It's declared first, so that it's destroyed after the
+         * services, whose instances may be allocated from it.
+         */
+        ScopeArenaPtr m_Arena;
+
+        /// Registered services
+        RegisteredServicesArray m_RegisteredServices;
+
+        /// Number of the services in @ref m_RegisteredServices
+        size_t m_OwnServiceCount = 0;
+
+        /// Pointer to the parent collection
+        ConstPtr m_Parent;
+
+        /// Pointer to the scoped service slots or `nullptr` if there are none
+        ScopedServiceSlotsPtr m_ScopedSlots;
+        /**
+         * @brief Finds DI services, registered for a service type
+         * in this collection, ignoring the parent collection
+         * @param typeId service type ID
+         * @returns pointer to the DI services vector or `nullptr`
+         * if no services were registered for the type
+         */
+        const DIServicesVector* FindOwnDIServices(TypeId typeId) const
         {
-            solinject_req_assert(diServicePtr != nullptr);
+            if (typeId >= m_RegisteredServices.size())
+                return nullptr;
+
+            return &m_RegisteredServices[typeId];
+        }
+
+        /**
+         * @brief Finds slot indices of the scoped services,
+         * registered for a service type in this collection
+         * @param typeId service type ID
+         * @returns pointer to the slot indices vector or `nullptr`
+         * if no scoped services were registered for the type
+         */
+        const SlotIndicesVector* FindScopedSlotIndices(TypeId typeId) const
+        {
+            if (m_ScopedSlots == nullptr)
+                return nullptr;
+
+            return m_ScopedSlots->FindSlotIndices(typeId);
+        }
+
+        /**
+         * @brief Finds the last DI service, registered for a service
+         * type in this collection, ignoring the parent collection
+         *
+         * If the found service is a scoped service,
+         * which wasn't resolved yet, its DI service is built.
+         *
+         * @param typeId service type ID
+         * @returns pointer to the DI service or `nullptr`
+         * if no services were registered for the type
+         */
+        const RegisteredService* FindOwnDIService(TypeId typeId) const
+        {
+            if (const DIServicesVector* diServices = FindOwnDIServices(typeId);
+                diServices != nullptr && !diServices->empty())
+            {
+                return &diServices->back();
+            }
 
-            auto castedDiServicePtr = std::dynamic_pointer_cast<IServiceTyped<T>>(diServicePtr);
+            if (const SlotIndicesVector* slotIndices = FindScopedSlotIndices(typeId);
+                slotIndices != nullptr && !slotIndices->empty())
+            {
+                return &m_ScopedSlots->GetDIService(slotIndices->back());
+            }
+
+            return nullptr;
+        }
 
-            solinject_req_assert(castedDiServicePtr != nullptr && "The service is resolvable as T");
+        /**
+         * @brief Registers a service
+         * @param typeId service type ID
+         * @param diService pointer to a DI service instance
+         */
+        void RegisterServiceInternal(TypeId typeId, RegisteredService diService)
+        {
+            if (typeId >= m_RegisteredServices.size())
+                m_RegisteredServices.resize(typeId + 1);
 
-            return castedDiServicePtr->GetService(container);
+            m_RegisteredServices[typeId].push_back(std::move(diService));
+            m_OwnServiceCount++;
+        }
+
+        /**
+         * @brief Registers a service
+         * @tparam TService service type
+         * @tparam TDISevice DI service type
+         * @tparam TArgs DI service constructor arguments types
+         * @param args DI service constructor arguments
+         */
+        template <class TService, class TDIService, class...TArgs>
+        void RegisterServiceInternal(TArgs&&...args)
+        {
+            RegisterServiceInternal(
+                GetTypeId<TService>(),
+                RegisteredService::template Create<TService>(std::make_shared<TDIService>(std::forward<TArgs>(args)...))
+            );
         }
 
         /**
@@ -316,26 +674,12 @@ namespace sol::di::impl
         template <class T, bool nothrow>
         ServicePtr<T> GetServiceInternal(const Container& container) const
         {
-            using namespace std::string_literals;
-
-            auto serviceIt = m_RegisteredServices.find(std::type_index(typeid(T)));
-
-            bool serviceFound =
-                serviceIt != m_RegisteredServices.end() &&
-                !serviceIt->second.empty();
-
-            if constexpr (!nothrow)
-                solinject_assert(serviceFound);
-
-            if (!serviceFound)
-                if constexpr (nothrow)
-                    return nullptr;
-                else
-                    throw exc::ServiceNotRegisteredException(typeid(T));
+            const RegisteredService* diService = FindDIService<T, nothrow>();
 
-            auto& services = serviceIt->second;
+            if (diService == nullptr)
+                return nullptr;
 
-            return GetServiceInstance<T>(*services.rbegin(), container);
+            return diService->template Resolve<T>(container);
         }
     };
 }
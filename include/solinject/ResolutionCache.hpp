@@ -0,0 +1,156 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Generation of a container's registrations
+     *
+     * Generations are unique within the process, so a generation
+     * identifies both the container and the state of its registrations.
+     */
+    using ContainerGeneration = std::uint64_t;
+
+    /**
+     * @brief Gets a new container generation
+     * @returns the generation
+     */
+    inline ContainerGeneration NextContainerGeneration()
+    {
+        static std::atomic<ContainerGeneration> lastGeneration = 0;
+        return lastGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /**
+     * @brief Thread-local cache of the last resolved instances of a service
+     *
+     * Each thread holds a few entries per service type, keyed by the
+     * container and its generation, so resolving the service from
+     * several containers or scopes in turn doesn't evict the entries
+     * of each other. When all the entries are in use, the oldest one
+     * is replaced.
+     *
+     * The cache doesn't own the instances. A thread-local owner would
+     * keep scoped instances alive after their scope is destroyed, and
+     * instances, allocated from the scope's memory arena, after the
+     * arena is released. Locking a @ref std::weak_ptr costs about the
+     * same as copying a @ref std::shared_ptr: a single atomic operation
+     * on the reference counter.
+     *
+     * @tparam T service type
+     */
+    template <class T>
+    class ResolutionCache
+    {
+    public:
+        /**
+         * @brief Finds a cached instance of the service
+         * @param container the container the service is resolved from
+         * @param generation the container's current generation
+         * @returns pointer to the instance or `nullptr`
+         * if the instance is not cached
+         */
+        static std::shared_ptr<T> Find(const void* container, ContainerGeneration generation)
+        {
+            for (const Entry& entry : GetEntries().entries)
+                if (entry.container == container && entry.generation == generation)
+                    return entry.instance.lock();
+
+            return nullptr;
+        }
+
+        /**
+         * @brief Caches an instance of the service
+         *
+         * The entry of the container is replaced, if it exists.
+         * Otherwise the oldest entry is replaced.
+         *
+         * @param container the container the service was resolved from
+         * @param generation the container's generation, read
+         * before the service was resolved
+         * @param instance the instance
+         */
+        static void Store(const void* container, ContainerGeneration generation, const std::shared_ptr<T>& instance)
+        {
+            Entries& entries = GetEntries();
+
+            Entry* entry = nullptr;
+
+            for (Entry& existingEntry : entries.entries)
+                if (existingEntry.container == container)
+                    entry = &existingEntry;
+
+            if (entry == nullptr)
+            {
+                entry = &entries.entries[entries.nextIndex];
+                entries.nextIndex = (entries.nextIndex + 1) % EntryCount;
+            }
+
+            entry->container = container;
+            entry->generation = generation;
+            entry->instance = instance;
+        }
+
+    private:
+        /// Number of the entries per thread
+        static constexpr std::size_t EntryCount = 4;
+
+        /// Cache entry
+        struct Entry
+        {
+            /// The container the instance was resolved from
+            const void* container = nullptr;
+
+            /// The container's generation
+            ContainerGeneration generation = 0;
+
+            /// The instance
+            std::weak_ptr<T> instance;
+        };
+
+        /// Cache entries of a thread
+        struct Entries
+        {
+            /// The entries
+            Entry entries[EntryCount];
+
+            /// Index of the entry, which is replaced next
+            std::size_t nextIndex = 0;
+        };
+
+        /**
+         * @brief Gets the current thread's cache entries
+         * @returns the entries
+         */
+        static Entries& GetEntries()
+        {
+            thread_local Entries entries;
+            return entries;
+        }
+    };
+}
@@ -0,0 +1,240 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <memory_resource>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "RegisteredServices.hpp"
+#include "Container.hpp"
+
+namespace sol::di
+{
+    namespace impl
+    {
+        template <class T, class TThreadingPolicy>
+        class InlineCache;
+    }
+
+    /**
+     * @brief Context of a service resolution
+     *
+     * Factory functions may accept a `const` reference to a
+     * resolution context instead of a `const` reference to a
+     * @ref BasicContainer. The context is created implicitly from the
+     * container and provides the same methods for resolving services.
+     *
+     * The context pins the registered services once, so the services,
+     * resolved through it, don't lock the container's mutex. Contexts,
+     * created for the same container on the same thread while another
+     * context is alive (i.e. by factories of the dependencies), reuse
+     * that context's registered services, so resolving a whole
+     * dependency tree locks the mutex at most once. Circular
+     * dependencies are detected as usual.
+     *
+     * The @ref FACTORY() macro creates factory functions,
+     * which accept a resolution context.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @headerfile ResolutionContext.hpp solinject.hpp
+     */
+    template <class TThreadingPolicy>
+    class BasicResolutionContext
+    {
+    public:
+        /// Threading policy of the DI container
+        using ThreadingPolicy = TThreadingPolicy;
+
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /**
+         * @copydoc BasicContainer::ServicePtr
+         * @tparam T service type
+         */
+        template <class T>
+        using ServicePtr = typename Container::template ServicePtr<T>;
+
+        /**
+         * @brief Constructor
+         * @param[in] container the container, which the services are
+         * resolved from. It must outlive the context.
+         */
+        BasicResolutionContext(const Container& container) :
+            m_Container(container),
+            m_Outer(Current())
+        {
+            if (m_Outer != nullptr && &m_Outer->m_Container == &container)
+            {
+                m_Services = m_Outer->m_Services;
+                m_Generation = m_Outer->m_Generation;
+            }
+            else if (container.IsFrozen())
+            {
+                m_Services = container.m_RegisteredServices.get();
+                m_Generation = container.m_Generation.load(std::memory_order_acquire);
+            }
+            else
+            {
+                {
+                    // The generation is changed only while the mutex
+                    // is locked exclusively, so it matches the services
+                    auto lock = container.LockMutexForReading();
+                    m_PinnedServices = typename RegisteredServices::ConstPtr(container.m_RegisteredServices);
+                    m_Generation = container.m_Generation.load(std::memory_order_acquire);
+                }
+
+                m_Services = m_PinnedServices.get();
+            }
+
+            Current() = this;
+        }
+
+        /// Copy constructor (deleted)
+        BasicResolutionContext(const BasicResolutionContext& other) = delete;
+
+        /// Copy-assignment operator (deleted)
+        BasicResolutionContext& operator=(const BasicResolutionContext& other) = delete;
+
+        /// Destructor
+        ~BasicResolutionContext()
+        {
+            Current() = m_Outer;
+        }
+
+        /**
+         * @brief Gets the container, which the services are resolved from
+         * @returns the container
+         */
+        const Container& GetContainer() const { return m_Container; }
+
+        /// @copydoc GetContainer()
+        operator const Container&() const { return m_Container; }
+
+        /// @copydoc BasicContainer::GetRequiredService()
+        template <class T>
+        ServicePtr<T> GetRequiredService() const
+        {
+            return m_Services->template GetRequiredService<T>(m_Container);
+        }
+
+        /// @copydoc BasicContainer::GetRequiredServiceRef()
+        template <class T>
+        T& GetRequiredServiceRef() const
+        {
+            return m_Services->template FindDIService<T, false>()->template Borrow<T>(m_Container);
+        }
+
+        /// @copydoc BasicContainer::GetService()
+        template <class T>
+        ServicePtr<T> GetService() const
+        {
+            return m_Services->template GetService<T>(m_Container);
+        }
+
+        /// @copydoc BasicContainer::GetServices()
+        template <class T>
+        std::vector<ServicePtr<T>> GetServices() const
+        {
+            return m_Services->template GetServices<T>(m_Container);
+        }
+
+        /// @copydoc BasicContainer::GetRequiredServices()
+        template <class...T>
+        std::tuple<ServicePtr<T>...> GetRequiredServices() const
+        {
+            static_assert(sizeof...(T) > 0, "At least one service type must be specified");
+
+            // Braced initialization resolves the services in order
+            return std::tuple<ServicePtr<T>...> {
+                m_Services->template GetRequiredService<T>(m_Container)...
+            };
+        }
+
+        /// @copydoc BasicContainer::ForEachService()
+        template <class T, class TCallback>
+        void ForEachService(TCallback&& callback) const
+        {
+            m_Services->template ForEachService<T>(m_Container, callback);
+        }
+
+        /// @copydoc BasicContainer::GetMemoryResource()
+        std::pmr::memory_resource* GetMemoryResource() const
+        {
+            return m_Container.GetMemoryResource();
+        }
+
+        /// @copydoc BasicContainer::AllocateShared()
+        template <class T, class...TArgs>
+        std::shared_ptr<T> AllocateShared(TArgs&&...args) const
+        {
+            return m_Container.template AllocateShared<T>(std::forward<TArgs>(args)...);
+        }
+
+    private:
+        template <class, class>
+        friend class impl::InlineCache;
+
+        /// Registered services of the DI container
+        using RegisteredServices = impl::RegisteredServices<TThreadingPolicy>;
+
+        /// The container, which the services are resolved from
+        const Container& m_Container;
+
+        /// The innermost context of the current thread, which was alive when this one was created
+        const BasicResolutionContext* m_Outer;
+
+        /// Pinned registered services or `nullptr` if they don't need pinning
+        typename RegisteredServices::ConstPtr m_PinnedServices;
+
+        /// The registered services
+        const RegisteredServices* m_Services = nullptr;
+
+        /// Generation of the container's registrations, which @ref m_Services belong to
+        impl::ContainerGeneration m_Generation = 0;
+
+        /**
+         * @brief Gets the innermost context of the current thread
+         * @returns reference to the pointer to the context or `nullptr`
+         */
+        static const BasicResolutionContext*& Current()
+        {
+            thread_local const BasicResolutionContext* current = nullptr;
+            return current;
+        }
+    };
+
+    /**
+     * @brief Deduction guide, which deduces the threading policy
+     * of a resolution context from its container
+     */
+    template <class TThreadingPolicy>
+    BasicResolutionContext(const BasicContainer<TThreadingPolicy>&) -> BasicResolutionContext<TThreadingPolicy>;
+
+    /**
+     * @brief Context of a service resolution from a @ref Container
+     * @see BasicResolutionContext
+     */
+    using ResolutionContext = BasicResolutionContext<DefaultThreadingPolicy>;
+}
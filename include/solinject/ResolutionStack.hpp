@@ -0,0 +1,96 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <typeinfo>
+#include "solinject/Defines.hpp"
+#include "solinject/exceptions/CircularDependencyException.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Stack of DI services, which are being
+     * resolved by the current thread
+     *
+     * The stack is thread-local, so detecting circular
+     * dependencies doesn't write to memory shared with
+     * other threads. Guards are popped during stack unwinding,
+     * so a throwing factory doesn't leave stale entries behind.
+     */
+    class ResolutionStack
+    {
+    public:
+        /**
+         * @brief RAII guard, which pushes a DI service onto
+         * the current thread's resolution stack and pops it
+         * when the guard is destroyed
+         */
+        class Guard
+        {
+        public:
+            /**
+             * @brief Constructor
+             * @param service DI service, which is being resolved
+             * @param type type of the service, which is being resolved
+             * @throws sol::di::exc::CircularDependencyException
+             */
+            Guard(const void* service, const std::type_info& type)
+            {
+                auto& stack = Current();
+
+                bool isCircular = std::find(stack.begin(), stack.end(), service) != stack.end();
+
+                solinject_assert(!isCircular && "There are no circular dependencies");
+
+                if (isCircular)
+                    throw exc::CircularDependencyException(type);
+
+                stack.push_back(service);
+            }
+
+            /// Copy constructor (deleted)
+            Guard(const Guard& other) = delete;
+
+            /// Copy-assignment operator (deleted)
+            Guard& operator=(const Guard& other) = delete;
+
+            /// Destructor
+            ~Guard()
+            {
+                Current().pop_back();
+            }
+        };
+
+    private:
+        /**
+         * @brief Gets the current thread's resolution stack
+         * @returns the resolution stack
+         */
+        static std::vector<const void*>& Current()
+        {
+            thread_local std::vector<const void*> stack;
+            return stack;
+        }
+    };
+}
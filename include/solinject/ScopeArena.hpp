@@ -0,0 +1,111 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+
+#include "solinject/Utils.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Memory arena of a scope
+     *
+     * Memory is allocated from a monotonic buffer, so deallocation
+     * is a no-op, and all the memory is released in bulk when
+     * the arena is destroyed or reset.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
+    class ScopeArena : public std::pmr::memory_resource
+    {
+    public:
+        /**
+         * @brief Constructor
+         * @param isThreadSafe `false` if the arena is used
+         * by one thread at a time, so it doesn't need locking
+         */
+        ScopeArena(bool isThreadSafe = true) : m_IsThreadSafe(isThreadSafe) {}
+
+        /// Copy constructor (deleted)
+        ScopeArena(const ScopeArena& other) = delete;
+
+        /// Copy-assignment operator (deleted)
+        ScopeArena& operator=(const ScopeArena& other) = delete;
+
+        /**
+         * @brief Releases all the allocated memory
+         * @warning Objects, allocated from the arena,
+         * must be destroyed before calling this method
+         */
+        void Release()
+        {
+            if (!m_IsThreadSafe)
+            {
+                m_Resource.release();
+                return;
+            }
+
+            Lock lock(m_Mutex);
+            m_Resource.release();
+        }
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (!m_IsThreadSafe)
+                return m_Resource.allocate(bytes, alignment);
+
+            Lock lock(m_Mutex);
+            return m_Resource.allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        /// Mutex type
+        using Mutex = DiscardableMutex<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = DiscardableLock<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// The underlying memory resource
+        std::pmr::monotonic_buffer_resource m_Resource;
+
+        /// Mutex, which guards @ref m_Resource
+        Mutex m_Mutex;
+
+        /// Field, indicating if @ref m_Mutex is used
+        bool m_IsThreadSafe;
+    };
+}
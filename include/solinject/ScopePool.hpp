@@ -0,0 +1,243 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include "Defines.hpp"
+#include "Utils.hpp"
+#include "Container.hpp"
+
+namespace sol::di
+{
+    /**
+     * @brief Pool of reusable scope containers
+     *
+     * Creating a scope for every unit of work (e.g. for every request,
+     * handled by a server) allocates memory for the scope bookkeeping.
+     * The pool creates scopes in advance and reuses them: when a scope
+     * is returned to the pool, its scoped service instances are destroyed
+     * and its registrations are removed, but its storage is kept.
+     *
+     * A scope, acquired from the pool, sees the services, registered
+     * in the container at the moment of acquisition.
+     *
+     * The pool may be used from multiple threads, but every
+     * acquired scope follows the rules of a regular scope.
+     *
+     * @warning The pool must not outlive the container it was created from
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @headerfile ScopePool.hpp solinject.hpp
+     */
+    template <class TThreadingPolicy>
+    class BasicScopePool
+    {
+    public:
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /**
+         * @brief Scope, acquired from a @ref BasicScopePool
+         *
+         * The scope is returned to the pool on destruction.
+         *
+         * @warning The scope container must not be moved from
+         */
+        class PooledScope
+        {
+        public:
+            /// Default constructor
+            PooledScope() {}
+
+            /// Copy constructor (deleted)
+            PooledScope(const PooledScope& other) = delete;
+
+            /// Move constructor
+            PooledScope(PooledScope&& other) noexcept
+            {
+                swap(*this, other);
+            }
+
+            /// Assignment operator
+            PooledScope& operator=(PooledScope other) noexcept
+            {
+                swap(*this, other);
+                return *this;
+            }
+
+            /// Destructor, which returns the scope to the pool
+            ~PooledScope()
+            {
+                if (m_Scope != nullptr)
+                    m_Pool->Release(m_Scope);
+            }
+
+            /// Swaps two @ref PooledScope instances
+            friend void swap(PooledScope& a, PooledScope& b) noexcept
+            {
+                using std::swap;
+
+                swap(a.m_Pool, b.m_Pool);
+                swap(a.m_Scope, b.m_Scope);
+            }
+
+            /**
+             * @brief Gets the scope container
+             * @returns the scope container
+             */
+            Container& Get() const
+            {
+                solinject_req_assert(m_Scope != nullptr);
+                return *m_Scope;
+            }
+
+            /// @copydoc Get()
+            Container& operator*() const { return Get(); }
+
+            /// @copydoc Get()
+            Container* operator->() const { return &Get(); }
+
+        private:
+            friend class BasicScopePool;
+
+            /**
+             * @brief Constructor
+             * @param pool the pool, which owns the scope
+             * @param scope the scope container
+             */
+            PooledScope(BasicScopePool* pool, Container* scope) :
+                m_Pool(pool),
+                m_Scope(scope)
+            {
+            }
+
+            /// The pool, which owns the scope
+            BasicScopePool* m_Pool = nullptr;
+
+            /// The scope container
+            Container* m_Scope = nullptr;
+        };
+
+        /**
+         * @brief Constructor
+         * @param container the container to create scopes from
+         * @param size number of scopes to create in advance
+         */
+        BasicScopePool(const Container& container, size_t size) :
+            m_Container(container)
+        {
+            m_Scopes.reserve(size);
+            m_FreeScopes.reserve(size);
+
+            for (size_t i = 0; i < size; i++)
+            {
+                m_Scopes.push_back(std::make_unique<Container>(m_Container.CreateScope()));
+                m_FreeScopes.push_back(m_Scopes.back().get());
+            }
+        }
+
+        /// Copy constructor (deleted)
+        BasicScopePool(const BasicScopePool& other) = delete;
+
+        /// Copy-assignment operator (deleted)
+        BasicScopePool& operator=(const BasicScopePool& other) = delete;
+
+        /**
+         * @brief Acquires a scope from the pool
+         *
+         * If all the pooled scopes are in use,
+         * a new scope is created and added to the pool.
+         *
+         * @returns the acquired scope
+         */
+        PooledScope Acquire()
+        {
+            Container* scope = nullptr;
+
+            {
+                Lock lock(m_Mutex);
+
+                if (!m_FreeScopes.empty())
+                {
+                    scope = m_FreeScopes.back();
+                    m_FreeScopes.pop_back();
+                }
+            }
+
+            if (scope != nullptr)
+            {
+                scope->RebindPooledScope(m_Container);
+                return PooledScope(this, scope);
+            }
+
+            auto newScope = std::make_unique<Container>(m_Container.CreateScope());
+            scope = newScope.get();
+
+            Lock lock(m_Mutex);
+
+            m_Scopes.push_back(std::move(newScope));
+            m_FreeScopes.reserve(m_Scopes.size());
+
+            return PooledScope(this, scope);
+        }
+
+    private:
+        /// Mutex type
+        using Mutex = impl::DiscardableMutex<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = impl::DiscardableLock<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// The container to create scopes from
+        const Container& m_Container;
+
+        /// All the scopes, owned by the pool
+        std::vector<std::unique_ptr<Container>> m_Scopes;
+
+        /// Scopes, which are not in use
+        std::vector<Container*> m_FreeScopes;
+
+        /// Mutex, which guards @ref m_Scopes and @ref m_FreeScopes
+        Mutex m_Mutex;
+
+        /**
+         * @brief Returns a scope to the pool
+         * @param scope the scope
+         */
+        void Release(Container* scope)
+        {
+            scope->ResetPooledScope();
+
+            Lock lock(m_Mutex);
+            m_FreeScopes.push_back(scope);
+        }
+    };
+
+    /**
+     * @brief Pool of reusable scope containers of a @ref Container
+     * @see BasicScopePool
+     */
+    using ScopePool = BasicScopePool<DefaultThreadingPolicy>;
+}
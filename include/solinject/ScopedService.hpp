@@ -22,16 +22,29 @@
 
 #pragma once
 #include "SingletonService.hpp"
+#include "Factory.hpp"
 
 namespace sol::di::impl
 {
     /**
      * @brief Scoped DI service
-     * @tparam T service type
+     *
+     * The service doesn't copy the factory function. It refers
+     * to the factory function of the builder, which built the service.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TService service type
+     * @tparam TFactory factory function type
+     * @tparam TServiceParents types, which the service is also resolvable as
      */
-    template<class TService, class...TServiceParents>
+    template<
+        class TThreadingPolicy,
+        class TService,
+        class TFactory = typename IServiceTyped<TThreadingPolicy, TService>::Factory,
+        class...TServiceParents
+    >
     class ScopedService :
-        public SingletonService<TService, TServiceParents...>
+        public SingletonService<TThreadingPolicy, TService, FactoryRef<TFactory>, TServiceParents...>
     {
         static_assert(
             std::conjunction_v<std::is_base_of<TServiceParents, TService>...>,
@@ -39,20 +52,30 @@ namespace sol::di::impl
         );
     public:
         /// Base of the @ref ScopedService class
-        using Base = SingletonService<TService, TServiceParents...>;
+        using Base = SingletonService<TThreadingPolicy, TService, FactoryRef<TFactory>, TServiceParents...>;
 
-        /// @copydoc SingletonService<T>::Factory
-        using Factory = typename Base::Factory;
-
-        /// @copydoc sol::di::impl::IService::VoidPtr
-        using VoidPtr = typename IService::VoidPtr;
+        /// Factory function type
+        using Factory = TFactory;
 
         /**
          * @brief Constructor
-         * @param factory factory function
+         * @param factory factory function, which must
+         * outlive the service
          */
-        ScopedService(Factory factory) : Base(factory)
+        ScopedService(const Factory& factory) : Base(FactoryRef<Factory>(factory))
+        {
+        }
+
+        /// @copydoc sol::di::impl::IService::Lifetime
+        virtual ServiceLifetime Lifetime() const override
+        {
+            return ServiceLifetime::Scoped;
+        }
+
+        /// @copydoc sol::di::impl::IService::Reset
+        virtual void Reset() override
         {
+            Base::DestroyService();
         }
-    }; // class SingletonService
+    }; // class ScopedService
 } // sol::di::impl
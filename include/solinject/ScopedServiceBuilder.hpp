@@ -27,10 +27,22 @@ namespace sol::di::impl
 {
     /**
      * @brief Builder for scoped DI services
-     * @tparam T service type
+     *
+     * Built services refer to the builder's factory function,
+     * so the builder must outlive them.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TService service type
+     * @tparam TFactory factory function type
+     * @tparam TServiceParents types, which the service is also resolvable as
      */
-    template<class TService, class...TServiceParents>
-    class ScopedServiceBuilder : public IScopedServiceBuilder
+    template<
+        class TThreadingPolicy,
+        class TService,
+        class TFactory = typename IServiceTyped<TThreadingPolicy, TService>::Factory,
+        class...TServiceParents
+    >
+    class ScopedServiceBuilder : public IScopedServiceBuilder<TThreadingPolicy>
     {
         static_assert(
             std::conjunction_v<std::is_base_of<TServiceParents, TService>...>,
@@ -38,22 +50,22 @@ namespace sol::di::impl
         );
     public:
         /// Base for the @ref ScopedServiceBuilder class
-        using Base = IScopedServiceBuilder;
+        using Base = IScopedServiceBuilder<TThreadingPolicy>;
 
         /// Type of the DI service that is being built
-        using DIService = ScopedService<TService, TServiceParents...>;
+        using DIService = ScopedService<TThreadingPolicy, TService, TFactory, TServiceParents...>;
         
         /// @copydoc IScopedServiceBuilder::DIServicePtr
         using AbstractDIServicePtr = typename Base::DIServicePtr;
 
-        /// @copydoc ScopedService<TService>::Factory
-        using Factory = typename DIService::Factory;
+        /// Factory function type
+        using Factory = TFactory;
 
         /**
          * @brief Constructor
          * @param factory factory function
          */
-        ScopedServiceBuilder(Factory factory) : m_Factory(factory)
+        ScopedServiceBuilder(Factory factory) : m_Factory(std::move(factory))
         {
         }
 
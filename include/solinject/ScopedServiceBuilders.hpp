@@ -22,61 +22,68 @@
 
 #pragma once
 
-#include <map>
 #include <vector>
-#include <algorithm>
 #include <memory>
 #include <typeinfo>
 #include <typeindex>
-#include <iterator>
 
+#include "TypeId.hpp"
+#include "PinnedPtr.hpp"
 #include "IService.hpp"
 #include "IServiceTyped.hpp"
 #include "ScopedServiceBuilder.hpp"
+#include "Factory.hpp"
 
 namespace sol::di::impl
 {
-    /// Scoped DI service builders collection
-    class ScopedServiceBuilders
+    /**
+     * @brief Scoped DI service builders collection
+     *
+     * Each registered builder gets a slot index. A scope reserves
+     * one slot per builder and builds the DI services lazily
+     * (see @ref ScopedServiceSlots).
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
+    class ScopedServiceBuilders : public Pinnable
     {
     public:
         /**
-         * @copydoc IServiceTyped<T>::Factory
+         * @copydoc IServiceTyped::Factory
          * @tparam T service type
          */
         template <class T>
-        using Factory = typename IServiceTyped<T>::Factory;
+        using Factory = typename IServiceTyped<TThreadingPolicy, T>::Factory;
 
         /**
-         * @copydoc IServiceTyped<T>::ServicePtr
+         * @copydoc IServiceTyped::ServicePtr
          * @tparam T service type
          */
         template <class T>
-        using ServicePtr = typename IServiceTyped<T>::ServicePtr;
-
-        /// Pointer to a @ref IService instance
-        using DIServicePtr = std::shared_ptr<IService>;
+        using ServicePtr = typename IServiceTyped<TThreadingPolicy, T>::ServicePtr;
 
         /// Pointer to a scoped service builder
-        using ScopedServiceBuilderPtr = std::shared_ptr<IScopedServiceBuilder>;
+        using ScopedServiceBuilderPtr = std::shared_ptr<IScopedServiceBuilder<TThreadingPolicy>>;
 
-        /// Map of registered DI services
-        using RegisteredServicesMap = std::map<std::type_index, std::vector<DIServicePtr>>;
+        /// Slot indices of the builders, registered for a single service type
+        using SlotIndicesVector = std::vector<size_t>;
 
-        /// Map of registered DI service builders
-        using RegisteredServiceBuildersMap = std::map<std::type_index, std::vector<ScopedServiceBuilderPtr>>;
+        /// Pointer to an immutable @ref ScopedServiceBuilders instance
+        using ConstPtr = PinnedPtr<ScopedServiceBuilders>;
 
         /**
          * @brief Registers a scoped service
          * @tparam T service type
+         * @tparam TFactory factory function type
          * @param factory factory function
          */
-        template<class T>
-        void RegisterScopedService(Factory<T> factory)
+        template<class T, class TFactory>
+        void RegisterScopedService(TFactory factory)
         {
             RegisterScopedService(
-                std::type_index(typeid(T)),
-                std::make_shared<ScopedServiceBuilder<T>>(factory)
+                GetTypeId<T>(),
+                std::make_shared<ScopedServiceBuilder<TThreadingPolicy, T, TFactory>>(std::move(factory))
             );
         }
 
@@ -87,42 +94,90 @@ namespace sol::di::impl
          */
         void RegisterScopedService(std::type_index type, ScopedServiceBuilderPtr serviceBuilder)
         {
-            m_RegisteredServiceBuilders[type].push_back(serviceBuilder);
+            RegisterScopedService(GetTypeId(type), serviceBuilder);
         }
 
         /**
-         * @brief Builds DI services
-         * @returns registered services map
+         * @brief Registers a scoped service
+         * @param typeId service type ID
+         * @param serviceBuilder service builder
          */
-        RegisteredServicesMap BuildDIServices() const
+        void RegisterScopedService(TypeId typeId, ScopedServiceBuilderPtr serviceBuilder)
         {
-            RegisteredServicesMap result;
+            if (typeId >= m_SlotIndices.size())
+                m_SlotIndices.resize(typeId + 1);
 
-            for (const auto& pair : m_RegisteredServiceBuilders)
-            {
-                auto& serviceBuilders = pair.second;
+            m_SlotIndices[typeId].push_back(m_Builders.size());
+            m_Builders.push_back(serviceBuilder);
+            m_SlotTypeIds.push_back(typeId);
+        }
 
-                std::vector<DIServicePtr> builtServices;
-                builtServices.reserve(serviceBuilders.size());
+        /// Removes all builders, keeping the allocated storage
+        void Clear()
+        {
+            m_Builders.clear();
+            m_SlotTypeIds.clear();
+
+            for (auto& slotIndices : m_SlotIndices)
+                slotIndices.clear();
+        }
 
-                std::transform(
-                    serviceBuilders.begin(),
-                    serviceBuilders.end(),
-                    std::back_inserter(builtServices),
-                    [](auto& builder)
-                    {
-                        return builder->BuildDIService();
-                    }
-                );
+        /**
+         * @brief Gets the number of registered builders
+         * @returns the number of registered builders
+         */
+        size_t Size() const { return m_Builders.size(); }
 
-                result[pair.first] = builtServices;
-            }
+        /**
+         * @brief Tells if no builders are registered
+         * @returns `true` if no builders are registered, `false` otherwise
+         */
+        bool IsEmpty() const { return m_Builders.empty(); }
 
-            return result;
+        /**
+         * @brief Finds slot indices of the builders,
+         * registered for a service type
+         * @param typeId service type ID
+         * @returns pointer to the slot indices vector or `nullptr`
+         * if no builders were registered for the type
+         */
+        const SlotIndicesVector* FindSlotIndices(TypeId typeId) const
+        {
+            if (typeId >= m_SlotIndices.size())
+                return nullptr;
+
+            return &m_SlotIndices[typeId];
+        }
+
+        /**
+         * @brief Gets a builder by its slot index
+         * @param slotIndex slot index
+         * @returns the builder
+         */
+        const ScopedServiceBuilderPtr& GetBuilder(size_t slotIndex) const
+        {
+            return m_Builders[slotIndex];
+        }
+
+        /**
+         * @brief Gets the ID of the service type, which
+         * a builder is registered for, by its slot index
+         * @param slotIndex slot index
+         * @returns the service type ID
+         */
+        TypeId GetSlotTypeId(size_t slotIndex) const
+        {
+            return m_SlotTypeIds[slotIndex];
         }
 
     private:
-        /// Registered service builders
-        RegisteredServiceBuildersMap m_RegisteredServiceBuilders;
+        /// Registered service builders in registration order
+        std::vector<ScopedServiceBuilderPtr> m_Builders;
+
+        /// Service type IDs of the registered builders, indexed by slot index
+        std::vector<TypeId> m_SlotTypeIds;
+
+        /// Slot indices of the registered builders, indexed by service type ID
+        std::vector<SlotIndicesVector> m_SlotIndices;
     };
 }
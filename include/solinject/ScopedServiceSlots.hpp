@@ -0,0 +1,221 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+#include "solinject/Defines.hpp"
+#include "solinject/Utils.hpp"
+#include "TypeId.hpp"
+#include "IService.hpp"
+#include "RegisteredService.hpp"
+#include "ScopedServiceBuilders.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Scoped DI services of a single scope
+     *
+     * The scope reserves an empty slot per registered scoped service
+     * builder. A slot's DI service is built only when it's resolved
+     * for the first time, so the scope creation cost doesn't depend
+     * on the number of registered scoped services.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
+    class ScopedServiceSlots
+    {
+    public:
+        /// Scoped service builders
+        using ScopedServiceBuilders = impl::ScopedServiceBuilders<TThreadingPolicy>;
+
+        /// DI service, registered for a service type
+        using RegisteredService = impl::RegisteredService<TThreadingPolicy>;
+
+        /// @copydoc ScopedServiceBuilders::SlotIndicesVector
+        using SlotIndicesVector = typename ScopedServiceBuilders::SlotIndicesVector;
+
+        /**
+         * @brief Constructor
+         * @param builders pointer to the scoped service builders
+         * @param isThreadSafe `false` if the slots are used
+         * by one thread at a time, so they don't need locking
+         */
+        ScopedServiceSlots(typename ScopedServiceBuilders::ConstPtr builders, bool isThreadSafe = true) :
+            m_Builders(std::move(builders)),
+            m_Slots(m_Builders->Size()),
+            m_IsThreadSafe(isThreadSafe)
+        {
+        }
+
+        /// Copy constructor (deleted)
+        ScopedServiceSlots(const ScopedServiceSlots& other) = delete;
+
+        /// Copy-assignment operator (deleted)
+        ScopedServiceSlots& operator=(const ScopedServiceSlots& other) = delete;
+
+        /**
+         * @brief Gets the scoped service builders
+         * @returns pointer to the scoped service builders
+         */
+        const typename ScopedServiceBuilders::ConstPtr& Builders() const { return m_Builders; }
+
+        /**
+         * @brief Finds slot indices of the scoped services,
+         * registered for a service type
+         * @param typeId service type ID
+         * @returns pointer to the slot indices vector or `nullptr`
+         * if no scoped services were registered for the type
+         */
+        const SlotIndicesVector* FindSlotIndices(TypeId typeId) const
+        {
+            return m_Builders->FindSlotIndices(typeId);
+        }
+
+        /**
+         * @brief Gets the DI service in a slot, building it
+         * if the slot is accessed for the first time
+         * @param slotIndex slot index
+         * @returns the DI service, which stays valid while
+         * the @ref ScopedServiceSlots instance exists
+         */
+        const RegisteredService& GetDIService(size_t slotIndex)
+        {
+            Slot& slot = m_Slots[slotIndex];
+
+            if (slot.isBuilt.load(std::memory_order_acquire))
+                return slot.diService;
+
+            if (!m_IsThreadSafe)
+                return BuildDIService(slot, slotIndex);
+
+            Lock lock(m_Mutex);
+
+            if (!slot.isBuilt.load(std::memory_order_relaxed))
+                BuildDIService(slot, slotIndex);
+
+            return slot.diService;
+        }
+
+        /**
+         * @brief Destroys the scoped service instances,
+         * keeping the built DI services for reuse
+         * @warning Must not be called while the services
+         * may be resolved by other threads
+         */
+        void Reset()
+        {
+            for (auto& slot : m_Slots)
+                if (slot.isBuilt.load(std::memory_order_relaxed))
+                    slot.diService.DIService()->Reset();
+        }
+
+        /**
+         * @brief Rebinds the slots to other scoped service builders
+         *
+         * If the builders are the same, nothing is changed.
+         * Otherwise all the slots are emptied.
+         *
+         * @warning Must not be called while the services
+         * may be resolved by other threads
+         * @param builders pointer to the scoped service builders
+         */
+        void Rebind(typename ScopedServiceBuilders::ConstPtr builders)
+        {
+            if (builders.get() == m_Builders.get())
+                return;
+
+            // The built DI services refer to the builders,
+            // so they are destroyed before the builders
+            if (m_Slots.size() != builders->Size())
+            {
+                m_Slots = std::vector<Slot>(builders->Size());
+            }
+            else
+            {
+                for (auto& slot : m_Slots)
+                {
+                    slot.diService = RegisteredService();
+                    slot.isBuilt.store(false, std::memory_order_relaxed);
+                }
+            }
+
+            m_Builders = std::move(builders);
+        }
+
+    private:
+        /// Mutex type
+        using Mutex = DiscardableMutex<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = DiscardableLock<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Slot for a scoped DI service
+        struct Slot
+        {
+            /// The DI service or an empty value if it's not built yet
+            RegisteredService diService;
+
+            /// Field, indicating if @ref diService is built
+            std::atomic<bool> isBuilt = false;
+        };
+
+        /**
+         * @brief Pointer to the scoped service builders
+         *
+         * It's declared before @ref m_Slots, so that the builders
+         * outlive the DI services, which refer to them.
+         */
+        typename ScopedServiceBuilders::ConstPtr m_Builders;
+
+        /// Slots, indexed by the builders' slot indices
+        std::vector<Slot> m_Slots;
+
+        /// Mutex, which guards building the DI services
+        Mutex m_Mutex;
+
+        /// Field, indicating if @ref m_Mutex is used
+        bool m_IsThreadSafe;
+
+        /**
+         * @brief Builds the DI service in a slot
+         * @param slot the slot
+         * @param slotIndex the slot's index
+         * @returns the DI service
+         */
+        const RegisteredService& BuildDIService(Slot& slot, size_t slotIndex)
+        {
+            auto diService = m_Builders->GetBuilder(slotIndex)->BuildDIService();
+            solinject_req_assert(diService != nullptr);
+
+            slot.diService = RegisteredService(std::move(diService), m_Builders->GetSlotTypeId(slotIndex));
+            slot.isBuilt.store(true, std::memory_order_release);
+
+            return slot.diService;
+        }
+    };
+}
@@ -21,71 +21,139 @@
 /// @file
 
 #pragma once
+#include <memory>
+#include <type_traits>
+#include <typeinfo>
 #include "solinject/Defines.hpp"
+#include "TypeId.hpp"
 #include "IServiceTyped.hpp"
-#include "solinject/exceptions/CircularDependencyException.hpp"
+#include "ResolutionStack.hpp"
 
 namespace sol::di::impl
 {
-    /** 
-     * @brief Base for the DI service classes
-     * @tparam T service type
+    /**
+     * @brief Resolver of a DI service for one of the types,
+     * which the service is resolvable as
+     *
+     * The service instance is converted from the DI service's own
+     * pointer type directly, without casting through `void`.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam T the type, which the service is resolved as
+     * @tparam TDIService DI service type, which provides
+     * the `ResolveService()` method
      */
-    template <class T>
-    class ServiceBase : public IServiceTyped<T>
+    template <class TThreadingPolicy, class T, class TDIService>
+    class ServiceBase : public IServiceTyped<TThreadingPolicy, T>
     {
     public:
         /// Base of the ServiceBase class
-        using Base = IServiceTyped<T>;
+        using Base = IServiceTyped<TThreadingPolicy, T>;
 
         /// @copydoc sol::di::impl::IServiceTyped<T>::ServicePtr
         using ServicePtr = typename Base::ServicePtr;
 
-        /// @copydoc sol::di::impl::IServiceTyped<T>::Factory
-        using Factory = typename Base::Factory;
-
         /// @copydoc sol::di::impl::IService::Container
         using Container = typename Base::Container;
 
         virtual ~ServiceBase() = 0;
 
-        /**
-         * @brief Resolves the service and checks for circular dependencies
-         * @param[in] container DI container
-         * @returns pointer to a service instance
-         * @throws sol::di::exc::CircularDependencyException
-         */
-        virtual ServicePtr GetService(const Container& container)
+        /// @copydoc sol::di::impl::IServiceTyped<T>::GetService
+        virtual ServicePtr GetService(const Container& container) override final
+        {
+            return static_cast<TDIService*>(this)->ResolveService(container);
+        }
+
+        /// @copydoc sol::di::impl::IServiceTyped<T>::BorrowService
+        virtual T* BorrowService(const Container& container) override final
         {
-            solinject_assert(!m_IsLocked && "There are no circular dependencies");
+            return static_cast<TDIService*>(this)->BorrowInstance(container);
+        }
+    };
 
-            if (m_IsLocked)
-            {
-                m_IsLocked = false;
-                throw exc::CircularDependencyException(typeid(T));
-            }
+    template <class TThreadingPolicy, class T, class TDIService>
+    ServiceBase<TThreadingPolicy, T, TDIService>::~ServiceBase() {}
+
+    /**
+     * @brief Base for the DI service classes
+     *
+     * Implements @ref IServiceTyped for the service type
+     * and for each of the service parent types.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TDIService DI service type, which provides
+     * the `ResolveService()` method
+     * @tparam TService service type
+     * @tparam TServiceParents types, which the service is also resolvable as
+     */
+    template <class TThreadingPolicy, class TDIService, class TService, class...TServiceParents>
+    class DIServiceBase :
+        public ServiceBase<TThreadingPolicy, TService, TDIService>,
+        public ServiceBase<TThreadingPolicy, TServiceParents, TDIService>...
+    {
+        static_assert(
+            std::conjunction_v<std::is_base_of<TServiceParents, TService>...>,
+            "The TServiceParents types must be derived from the TService type"
+        );
+    public:
+        /// @copydoc sol::di::impl::IService::Container
+        using Container = typename IService<TThreadingPolicy>::Container;
 
-            m_IsLocked = true;
-            auto service = this->GetServiceAsVoidPtr(container);
-            m_IsLocked = false;
+        /// Pointer to an instance of the service
+        using ServicePtr = std::shared_ptr<TService>;
 
-            solinject_req_assert(service != nullptr);
+        virtual ~DIServiceBase() = 0;
 
-            return std::static_pointer_cast<T>(service);
+        /// @copydoc sol::di::impl::IService::GetResolver
+        virtual void* GetResolver(TypeId typeId) override
+        {
+            void* resolver = nullptr;
+
+            TryGetResolver<TService>(typeId, resolver) ||
+                (TryGetResolver<TServiceParents>(typeId, resolver) || ...);
+
+            return resolver;
+        }
+
+        /// @copydoc sol::di::impl::IService::ServiceType
+        virtual const std::type_info& ServiceType() const override
+        {
+            return typeid(TService);
         }
 
-    protected:
         /**
-         * @brief Field that indicates if the DI service is "locked"
-         * 
-         * When a DI service resolves a service, it becomes "locked"
-         * until an instance of the service is returned.
-         * If the DI service is already locked, it means 
-         * that we have detected a circular dependency.
+         * @brief Resolves the service by reference
+         *
+         * DI services, which own a single instance,
+         * hide this method.
+         *
+         * @param[in] container DI container
+         * @returns `nullptr`
          */
-        bool m_IsLocked = false;
+        TService* BorrowInstance(const Container& container)
+        {
+            return nullptr;
+        }
+
+    private:
+        /**
+         * @brief Gets the resolver for a type if its ID matches
+         * @tparam T the type
+         * @param typeId the requested type ID
+         * @param[out] resolver the resolver
+         * @returns `true` if the type ID matches, `false` otherwise
+         */
+        template <class T>
+        bool TryGetResolver(TypeId typeId, void*& resolver)
+        {
+            if (GetTypeId<T>() != typeId)
+                return false;
+
+            resolver = static_cast<IServiceTyped<TThreadingPolicy, T>*>(this);
+            return true;
+        }
     };
 
-    template <class T>
-    ServiceBase<T>::~ServiceBase() {}
+    template <class TThreadingPolicy, class TDIService, class TService, class...TServiceParents>
+    DIServiceBase<TThreadingPolicy, TDIService, TService, TServiceParents...>::~DIServiceBase() {}
 }
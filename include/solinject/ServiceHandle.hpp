@@ -0,0 +1,216 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include "Defines.hpp"
+#include "TypeId.hpp"
+#include "RegisteredService.hpp"
+#include "ScopedServiceBuilders.hpp"
+#include "ScopedServiceSlots.hpp"
+#include "Container.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Handle, which resolves a required service
+     * without searching the registered services and
+     * without owning the DI service it's bound to
+     *
+     * It's used by the resolution plans (see @ref InjectFactory),
+     * so the DI services of circular registrations don't own each
+     * other. The DI service must be kept alive by the caller.
+     *
+     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class T, class TThreadingPolicy>
+    class UnownedServiceHandle
+    {
+    public:
+        /// Pointer to an instance of the service
+        using ServicePtr = std::shared_ptr<T>;
+
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /// Default constructor. Creates an empty handle.
+        UnownedServiceHandle() {}
+
+        /**
+         * @brief Constructor, which binds the handle to
+         * the same service as a @ref ServiceHandle
+         * @param handle the handle
+         */
+        explicit UnownedServiceHandle(const ServiceHandle<T, TThreadingPolicy>& handle) :
+            UnownedServiceHandle(handle.m_Handle)
+        {
+        }
+
+        /// @copydoc sol::di::ServiceHandle::Get
+        ServicePtr Get(const Container& container) const
+        {
+            if (m_ScopedServiceBuilders == nullptr)
+                return m_Resolver->GetService(container);
+
+            ScopedServiceSlots<TThreadingPolicy>* slots = container.m_ScopedSlots;
+
+            if (slots != nullptr && slots->Builders().get() == m_ScopedServiceBuilders)
+                return slots->GetDIService(m_SlotIndex).template Resolve<T>(container);
+
+            return container.template GetRequiredService<T>();
+        }
+
+    private:
+        template <class, class>
+        friend class sol::di::ServiceHandle;
+
+        /// The resolver of the DI service, which the handle is bound to
+        IServiceTyped<TThreadingPolicy, T>* m_Resolver = nullptr;
+
+        /**
+         * @brief Pointer to the scoped service builders, which
+         * contain the scoped service registration, which the handle
+         * is bound to, or `nullptr` if the handle is bound to a DI service
+         */
+        const ScopedServiceBuilders<TThreadingPolicy>* m_ScopedServiceBuilders = nullptr;
+
+        /// Slot index of the scoped service registration
+        size_t m_SlotIndex = 0;
+    };
+}
+
+namespace sol::di
+{
+    /**
+     * @brief Handle, which resolves a required service
+     * without searching the registered services
+     *
+     * A handle is created by @ref BasicContainer::GetHandle(). It's bound
+     * either to a DI service or, for scoped services, to a scoped
+     * service registration. Registrations, made after the handle
+     * was created, are not taken into account.
+     *
+     * Handles are cheap to copy and may be used by multiple threads.
+     *
+     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @headerfile ServiceHandle.hpp solinject.hpp
+     */
+    template <class T, class TThreadingPolicy = DefaultThreadingPolicy>
+    class ServiceHandle
+    {
+    public:
+        /// Pointer to an instance of the service
+        using ServicePtr = std::shared_ptr<T>;
+
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /// Default constructor. Creates an empty handle.
+        ServiceHandle() {}
+
+        /**
+         * @brief Resolves the service
+         *
+         * If the handle is bound to a DI service, the DI service is
+         * resolved, and its factory receives @p container.
+         *
+         * If the handle is bound to a scoped service registration and
+         * @p container is a scope, created from the container the
+         * handle was taken from, the service is resolved from the
+         * scope's slot directly. Otherwise the service is looked up
+         * in @p container as usual.
+         *
+         * @param[in] container DI container, which is the container
+         * the handle was taken from or a scope, created from it
+         * @returns pointer to an instance of the service
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         */
+        ServicePtr Get(const Container& container) const
+        {
+            return m_Handle.Get(container);
+        }
+
+    private:
+        friend class BasicContainer<TThreadingPolicy>;
+
+        friend class impl::UnownedServiceHandle<T, TThreadingPolicy>;
+
+        /**
+         * @brief Constructor, which binds the handle
+         * @param[in] container DI container
+         * @throws sol::di::exc::ServiceNotRegisteredException
+         */
+        explicit ServiceHandle(const Container& container)
+        {
+            using namespace impl;
+
+            using RegisteredServices = impl::RegisteredServices<TThreadingPolicy>;
+            using ScopedServiceBuilders = impl::ScopedServiceBuilders<TThreadingPolicy>;
+
+            TypeId typeId = GetTypeId<T>();
+
+            {
+                auto lock = container.LockMutexUnlessFrozen();
+
+                const auto& builders = container.m_ScopedServiceBuilders;
+
+                if (auto slotIndices = builders->FindSlotIndices(typeId);
+                    slotIndices != nullptr && !slotIndices->empty())
+                {
+                    m_ScopedServiceBuilders = typename ScopedServiceBuilders::ConstPtr(builders);
+                    m_Handle.m_ScopedServiceBuilders = m_ScopedServiceBuilders.get();
+                    m_Handle.m_SlotIndex = slotIndices->back();
+                    return;
+                }
+            }
+
+            container.VisitRegisteredServices([this, typeId](const RegisteredServices& services)
+            {
+                if (services.FindOwnScopedSlotIndex(typeId, m_Handle.m_SlotIndex))
+                {
+                    m_ScopedServiceBuilders = services.GetScopedSlots()->Builders();
+                    m_Handle.m_ScopedServiceBuilders = m_ScopedServiceBuilders.get();
+                }
+                else
+                {
+                    m_DIService = *services.template FindDIService<T, false>();
+                    m_Handle.m_Resolver = m_DIService.template GetResolver<T>();
+                }
+            });
+        }
+
+        /// The DI service, which the handle is bound to
+        impl::RegisteredService<TThreadingPolicy> m_DIService;
+
+        /**
+         * @brief Pointer to the scoped service builders, which
+         * contain the scoped service registration, which the handle
+         * is bound to, or `nullptr` if the handle is bound to a DI service
+         */
+        typename impl::ScopedServiceBuilders<TThreadingPolicy>::ConstPtr m_ScopedServiceBuilders;
+
+        /// The handle, which doesn't own the DI service and the builders
+        impl::UnownedServiceHandle<T, TThreadingPolicy> m_Handle;
+    };
+}
@@ -0,0 +1,212 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <mutex>
+#include <type_traits>
+#include <typeinfo>
+#include "solinject/Defines.hpp"
+#include "solinject/Utils.hpp"
+#include "solinject/exceptions/CircularDependencyException.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Mutex, which guards the creation of a service instance
+     *
+     * @ref ResolutionStack only sees the services, which are being
+     * resolved by the current thread. If two threads create services,
+     * which depend on each other, each of them would wait forever for
+     * the mutex, held by the other one. So before a thread blocks, it
+     * follows the chain of the mutex owners and the mutexes they are
+     * waiting for. If the chain leads back to the thread, waiting
+     * would never end, and a circular dependency is reported instead.
+     *
+     * The owners and the mutexes they are waiting for are published
+     * and cleared only while @ref WaitGraphMutex() is locked. A thread,
+     * which is reachable from the chain, owns a mutex, so it can't exit
+     * while the chain is followed.
+     */
+    class ServiceMutex
+    {
+    public:
+        /// Default constructor
+        ServiceMutex() {}
+
+        /// Copy constructor (deleted)
+        ServiceMutex(const ServiceMutex& other) = delete;
+
+        /// Copy-assignment operator (deleted)
+        ServiceMutex& operator=(const ServiceMutex& other) = delete;
+
+        /**
+         * @brief Locks the mutex
+         * @param type type of the service, whose creation is guarded
+         * @throws sol::di::exc::CircularDependencyException
+         */
+        void lock(const std::type_info& type)
+        {
+            ThreadState& thisThread = CurrentThread();
+
+            if (!m_Mutex.try_lock())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(WaitGraphMutex());
+
+                    bool isCircular = LeadsTo(thisThread);
+
+                    solinject_assert(!isCircular && "There are no circular dependencies");
+
+                    if (isCircular)
+                        throw exc::CircularDependencyException(type);
+
+                    thisThread.waitingFor = this;
+                }
+
+                m_Mutex.lock();
+            }
+
+            std::lock_guard<std::mutex> lock(WaitGraphMutex());
+            thisThread.waitingFor = nullptr;
+            m_Owner = &thisThread;
+        }
+
+        /// Unlocks the mutex
+        void unlock()
+        {
+            {
+                std::lock_guard<std::mutex> lock(WaitGraphMutex());
+                m_Owner = nullptr;
+            }
+
+            m_Mutex.unlock();
+        }
+
+    private:
+        /// State of a thread, which is used to detect waiting cycles
+        struct ThreadState
+        {
+            /**
+             * @brief The mutex the thread is waiting for or `nullptr`
+             * @warning Guarded by @ref WaitGraphMutex()
+             */
+            const ServiceMutex* waitingFor = nullptr;
+        };
+
+        /// The underlying mutex
+        std::mutex m_Mutex;
+
+        /**
+         * @brief State of the thread, which owns the mutex, or `nullptr`
+         * @warning Guarded by @ref WaitGraphMutex()
+         */
+        const ThreadState* m_Owner = nullptr;
+
+        /**
+         * @brief Tells if waiting for the mutex would make
+         * a thread wait for itself
+         * @warning @ref WaitGraphMutex() must be locked by the caller
+         * @param thread the thread, which is about to wait
+         * @returns `true` if the thread would wait for itself, `false` otherwise
+         */
+        bool LeadsTo(const ThreadState& thread) const
+        {
+            for (const ServiceMutex* mutex = this; mutex != nullptr;)
+            {
+                const ThreadState* owner = mutex->m_Owner;
+
+                if (owner == nullptr)
+                    return false;
+
+                if (owner == &thread)
+                    return true;
+
+                mutex = owner->waitingFor;
+            }
+
+            return false;
+        }
+
+        /**
+         * @brief Gets the current thread's state
+         * @returns the thread state
+         */
+        static ThreadState& CurrentThread()
+        {
+            thread_local ThreadState state;
+            return state;
+        }
+
+        /**
+         * @brief Gets the mutex, which guards the owners of all the
+         * service mutexes and the @ref ThreadState::waitingFor
+         * fields of all the threads
+         * @returns the mutex
+         */
+        static std::mutex& WaitGraphMutex()
+        {
+            static std::mutex mutex;
+            return mutex;
+        }
+    };
+
+    /**
+     * @brief RAII lock of a @ref ServiceMutex
+     */
+    class ServiceLock
+    {
+    public:
+        /**
+         * @brief Constructor. Locks the mutex.
+         * @param mutex the mutex
+         * @param type type of the service, whose creation is guarded
+         * @throws sol::di::exc::CircularDependencyException
+         */
+        ServiceLock(ServiceMutex& mutex, const std::type_info& type) : m_Mutex(mutex)
+        {
+            m_Mutex.lock(type);
+        }
+
+        /// Copy constructor (deleted)
+        ServiceLock(const ServiceLock& other) = delete;
+
+        /// Copy-assignment operator (deleted)
+        ServiceLock& operator=(const ServiceLock& other) = delete;
+
+        /// Destructor. Unlocks the mutex.
+        ~ServiceLock()
+        {
+            m_Mutex.unlock();
+        }
+
+    private:
+        /// The locked mutex
+        ServiceMutex& m_Mutex;
+    };
+
+    /**
+     * @brief Lock of a @ref ServiceMutex, which can be discarded in compile-time
+     * @tparam isEnabled `true` if the lock should **NOT** be discarded, `false` otherwise
+     */
+    template <bool isEnabled>
+    using DiscardableServiceLock = std::conditional_t<isEnabled, ServiceLock, Empty>;
+}
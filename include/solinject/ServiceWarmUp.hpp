@@ -0,0 +1,258 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "solinject/Defines.hpp"
+#include "IService.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Shared state of a service warm-up
+     *
+     * The services are created in topological order of their
+     * dependency graph: a service is taken by a worker only when all
+     * the services, which it depends on, are created, so workers don't
+     * wait for each other, and independent services are created
+     * concurrently. Ready services are taken in the order they were
+     * passed in.
+     *
+     * The graph only has the dependencies, which are known in advance
+     * (see @ref IService::GetDependencies()). A service with unknown
+     * dependencies resolves them as usual when it's created: if
+     * another worker is creating a dependency, the service waits for
+     * it on the dependency's mutex. Services on a dependency cycle are
+     * taken right away, so creating them throws
+     * @ref sol::di::exc::CircularDependencyException as usual. Workers,
+     * which would wait for each other because of a circular dependency,
+     * throw it too (see @ref ServiceMutex), and @ref Wait() rethrows it.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     */
+    template <class TThreadingPolicy>
+    class ServiceWarmUp
+    {
+    public:
+        /// DI container
+        using Container = typename IService<TThreadingPolicy>::Container;
+
+        /// Pointer to a DI service instance
+        using DIServicePtr = std::shared_ptr<IService<TThreadingPolicy>>;
+
+        /**
+         * @brief Constructor
+         * @param[in] container DI container, which the services
+         * are resolved from
+         * @param services DI services to warm up
+         * @param[in] dependencies for each service, indices of
+         * the services, which it depends on
+         * @param workerCount number of workers, which will call @ref Run()
+         */
+        ServiceWarmUp(
+            const Container& container,
+            std::vector<DIServicePtr> services,
+            const std::vector<std::vector<size_t>>& dependencies,
+            size_t workerCount
+        ) :
+            m_Container(container),
+            m_Services(std::move(services)),
+            m_Dependents(m_Services.size()),
+            m_PendingDependencyCounts(m_Services.size()),
+            m_RemainingCount(m_Services.size()),
+            m_RunningWorkerCount(workerCount)
+        {
+            solinject_req_assert(dependencies.size() == m_Services.size());
+
+            std::vector<bool> isOrdered = OrderTopologically(dependencies);
+
+            // Edges to the services on cycles are dropped,
+            // so they don't wait for each other forever
+            for (size_t index = 0; index < m_Services.size(); index++)
+            {
+                if (!isOrdered[index])
+                    continue;
+
+                for (size_t dependency : dependencies[index])
+                {
+                    m_Dependents[dependency].push_back(index);
+                    m_PendingDependencyCounts[index]++;
+                }
+            }
+
+            for (size_t index = 0; index < m_Services.size(); index++)
+                if (m_PendingDependencyCounts[index] == 0)
+                    m_ReadyServices.push_back(index);
+        }
+
+        /**
+         * @brief Creates the services until there are none left
+         *
+         * Each worker calls this method once. If a factory throws,
+         * the workers stop taking new services.
+         */
+        void Run()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+
+            while (true)
+            {
+                m_StateChanged.wait(lock, [this]()
+                {
+                    return m_IsFailed || !m_ReadyServices.empty() || m_RemainingCount == 0;
+                });
+
+                if (m_IsFailed || m_ReadyServices.empty())
+                    break;
+
+                size_t index = m_ReadyServices.front();
+                m_ReadyServices.pop_front();
+
+                lock.unlock();
+
+                try
+                {
+                    m_Services[index]->WarmUp(m_Container);
+                    lock.lock();
+                }
+                catch (...)
+                {
+                    lock.lock();
+
+                    if (m_Exception == nullptr)
+                        m_Exception = std::current_exception();
+
+                    m_IsFailed = true;
+                    m_StateChanged.notify_all();
+                    continue;
+                }
+
+                for (size_t dependent : m_Dependents[index])
+                    if (--m_PendingDependencyCounts[dependent] == 0)
+                        m_ReadyServices.push_back(dependent);
+
+                m_RemainingCount--;
+                m_StateChanged.notify_all();
+            }
+
+            if (--m_RunningWorkerCount == 0)
+                m_StateChanged.notify_all();
+        }
+
+        /**
+         * @brief Waits for all the workers to finish and rethrows
+         * the first exception, thrown by a factory, if any
+         */
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+
+            m_StateChanged.wait(lock, [this]() { return m_RunningWorkerCount == 0; });
+
+            if (m_Exception != nullptr)
+                std::rethrow_exception(m_Exception);
+        }
+
+    private:
+        /// DI container
+        const Container& m_Container;
+
+        /// DI services to warm up
+        std::vector<DIServicePtr> m_Services;
+
+        /// For each service, indices of the services, which depend on it
+        std::vector<std::vector<size_t>> m_Dependents;
+
+        /// Mutex, which guards the fields below
+        std::mutex m_Mutex;
+
+        /**
+         * @brief Condition variable, which is notified when a service is
+         * created, a factory throws, or all the workers finish
+         */
+        std::condition_variable m_StateChanged;
+
+        /// For each service, number of its dependencies, which aren't created yet
+        std::vector<size_t> m_PendingDependencyCounts;
+
+        /// Indices of the services, whose dependencies are created
+        std::deque<size_t> m_ReadyServices;
+
+        /// Number of the services, which aren't created yet
+        size_t m_RemainingCount;
+
+        /// Number of workers, which haven't finished yet
+        size_t m_RunningWorkerCount;
+
+        /// Field, indicating if a factory has thrown
+        bool m_IsFailed = false;
+
+        /// The first exception, thrown by a factory
+        std::exception_ptr m_Exception;
+
+        /**
+         * @brief Finds the services, which can be ordered topologically
+         * @param[in] dependencies for each service, indices of
+         * the services, which it depends on
+         * @returns for each service, `true` if it can be ordered, `false`
+         * if it's on a dependency cycle or depends on a service on a cycle
+         */
+        static std::vector<bool> OrderTopologically(const std::vector<std::vector<size_t>>& dependencies)
+        {
+            std::vector<std::vector<size_t>> dependents(dependencies.size());
+            std::vector<size_t> pendingCounts(dependencies.size());
+            std::vector<size_t> orderedServices;
+            std::vector<bool> isOrdered(dependencies.size());
+
+            for (size_t index = 0; index < dependencies.size(); index++)
+            {
+                for (size_t dependency : dependencies[index])
+                    dependents[dependency].push_back(index);
+
+                pendingCounts[index] = dependencies[index].size();
+
+                if (pendingCounts[index] == 0)
+                    orderedServices.push_back(index);
+            }
+
+            while (!orderedServices.empty())
+            {
+                size_t index = orderedServices.back();
+                orderedServices.pop_back();
+                isOrdered[index] = true;
+
+                for (size_t dependent : dependents[index])
+                    if (--pendingCounts[dependent] == 0)
+                        orderedServices.push_back(dependent);
+            }
+
+            return isOrdered;
+        }
+    };
+}
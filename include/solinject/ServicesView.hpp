@@ -0,0 +1,133 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "IService.hpp"
+#include "RegisteredService.hpp"
+#include "RegisteredServices.hpp"
+#include "Container.hpp"
+
+namespace sol::di
+{
+    /**
+     * @brief View of the services, registered for a type
+     *
+     * A view is created by @ref BasicContainer::GetServicesView(). If there
+     * are services, registered for the type, and all of them are
+     * singletons, the view resolves them once and keeps the instances. Such a view is
+     * immutable: registrations, made after the view was created,
+     * are not taken into account.
+     *
+     * Otherwise the services are resolved from the container
+     * each time the view is iterated over.
+     *
+     * Views are cheap to copy and may be used by multiple threads.
+     *
+     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @headerfile ServicesView.hpp solinject.hpp
+     */
+    template <class T, class TThreadingPolicy = DefaultThreadingPolicy>
+    class ServicesView
+    {
+    public:
+        /// Pointer to an instance of the service
+        using ServicePtr = std::shared_ptr<T>;
+
+        /// DI container
+        using Container = BasicContainer<TThreadingPolicy>;
+
+        /// Vector of pointers to instances of the service
+        using ServicesVector = std::vector<ServicePtr>;
+
+        /// Default constructor. Creates a view, which isn't cached.
+        ServicesView() {}
+
+        /**
+         * @brief Tells if the view keeps the service instances
+         * @returns `true` if the view keeps the service instances,
+         * `false` if they are resolved each time
+         */
+        bool IsCached() const { return m_Services != nullptr; }
+
+        /**
+         * @brief Invokes a callback for each of the service
+         * instances in registration order
+         *
+         * If the view is cached, @p container is not used.
+         *
+         * @tparam TCallback callback type
+         * @param[in] container DI container, which is the container
+         * the view was taken from or a scope, created from it
+         * @param callback callback, which accepts a `const` reference
+         * to a pointer to a service instance
+         */
+        template <class TCallback>
+        void ForEach(const Container& container, TCallback&& callback) const
+        {
+            if (m_Services == nullptr)
+            {
+                container.template ForEachService<T>(callback);
+                return;
+            }
+
+            for (const ServicePtr& service : *m_Services)
+                callback(service);
+        }
+
+    private:
+        friend class BasicContainer<TThreadingPolicy>;
+
+        /**
+         * @brief Constructor
+         * @param[in] container DI container
+         */
+        explicit ServicesView(const Container& container)
+        {
+            using RegisteredServices = impl::RegisteredServices<TThreadingPolicy>;
+            using RegisteredService = impl::RegisteredService<TThreadingPolicy>;
+
+            container.VisitRegisteredServices([this, &container](const RegisteredServices& services)
+            {
+                bool isRegistered = false;
+                bool areSingletons = true;
+
+                services.template ForEachDIService<T>([&](const RegisteredService& diService)
+                {
+                    isRegistered = true;
+                    areSingletons = areSingletons &&
+                        diService.DIService()->Lifetime() == ServiceLifetime::Singleton;
+                });
+
+                // A view of a type without registrations isn't cached,
+                // so services, registered later, are visible through it
+                if (isRegistered && areSingletons)
+                    m_Services = std::make_shared<const ServicesVector>(services.template GetServices<T>(container));
+            });
+        }
+
+        /// Pointer to the service instances or `nullptr` if the view isn't cached
+        std::shared_ptr<const ServicesVector> m_Services;
+    };
+}
@@ -21,76 +21,165 @@
 /// @file
 
 #pragma once
+#include <typeinfo>
 #include "solinject/Defines.hpp"
+#include "solinject/Utils.hpp"
 #include "ServiceBase.hpp"
+#include "ServiceMutex.hpp"
+#include "Factory.hpp"
+#include "StartupRecorder.hpp"
 
 namespace sol::di::impl
 {
     /**
      * @brief Shared DI service
-     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TService service type
+     * @tparam TFactory factory function type
+     * @tparam TServiceParents types, which the service is also resolvable as
      */
-    template<class TService, class...TServiceParents>
+    template<
+        class TThreadingPolicy,
+        class TService,
+        class TFactory = typename IServiceTyped<TThreadingPolicy, TService>::Factory,
+        class...TServiceParents
+    >
     class SharedService :
-        public ServiceBase<TService>,
-        public ServiceBase<TServiceParents>...
+        public DIServiceBase<
+            TThreadingPolicy,
+            SharedService<TThreadingPolicy, TService, TFactory, TServiceParents...>,
+            TService,
+            TServiceParents...
+        >
     {
-        static_assert(
-            std::conjunction_v<std::is_base_of<TServiceParents, TService>...>,
-            "The TServiceParents types must be derived from the TService type"
-        );
     public:
         /// Base of the @ref SharedService class
-        using Base = ServiceBase<TService>;
+        using Base = DIServiceBase<TThreadingPolicy, SharedService, TService, TServiceParents...>;
 
-        /// @copydoc ServiceBase<TService>::Container
+        /// @copydoc sol::di::impl::DIServiceBase::Container
         using Container = typename Base::Container;
 
-        /// @copydoc ServiceBase<TService>::ServicePtr
+        /// @copydoc sol::di::impl::DIServiceBase::ServicePtr
         using ServicePtr = typename Base::ServicePtr;
 
-        /// @copydoc ServiceBase<TService>::Factory
-        using Factory = typename Base::Factory;
+        /// Factory function type
+        using Factory = TFactory;
 
         /// @ref std::weak_ptr to a service instance
         using ServiceWeakPtr = std::weak_ptr<TService>;
 
-        /// @copydoc sol::di::impl::IService::VoidPtr
-        using VoidPtr = typename IService::VoidPtr;
-
         /**
          * @brief Constructor
          * @param factory the factory function
          */
-        SharedService(Factory factory) : m_Factory(factory), m_ServicePtr()
+        SharedService(Factory factory) : m_ServicePtr(), m_Factory(std::move(factory))
         {
         }
 
-    protected:
-        virtual VoidPtr GetServiceAsVoidPtr(const Container& container) override
+        /// @copydoc sol::di::impl::IService::Lifetime
+        virtual ServiceLifetime Lifetime() const override
         {
-            ServicePtr instancePtr = m_ServicePtr.lock();
+            return ServiceLifetime::Shared;
+        }
+
+        /// @copydoc sol::di::impl::IService::CompilePlan
+        virtual void CompilePlan(const Container& container) override
+        {
+            if constexpr (HasResolutionPlan<Factory, Container>)
+                m_Factory.CompilePlan(container);
+        }
 
-            if (instancePtr != nullptr)
+        /// @copydoc sol::di::impl::IService::GetDependencies
+        virtual bool GetDependencies(std::vector<TypeId>& dependencies) const override
+        {
+            if constexpr (HasDependencyList<Factory>)
             {
-                return std::static_pointer_cast<void>(instancePtr);
+                m_Factory.GetDependencies(dependencies);
+                return true;
             }
             else
             {
-                ServicePtr newInstancePtr = m_Factory(container);
+                return false;
+            }
+        }
+
+        /**
+         * @brief Resolves the service and checks for circular dependencies
+         *
+         * If an instance of the service exists, it's returned.
+         * Otherwise a new instance is created.
+         *
+         * @param[in] container DI container
+         * @returns pointer to the service instance
+         * @throws sol::di::exc::CircularDependencyException
+         */
+        ServicePtr ResolveService(const Container& container)
+        {
+            ResolutionStack::Guard guard(this, typeid(TService));
 
-                solinject_req_assert(newInstancePtr != nullptr && "Factory should never return nullptr");
+            Lock lock(m_Mutex, typeid(TService));
 
-                m_ServicePtr = ServiceWeakPtr(newInstancePtr);
-                return std::static_pointer_cast<void>(newInstancePtr);
-            }
+            ServicePtr instancePtr = GetOrCreateInstance(container);
+
+            // The caller keeps the warmed up instance alive from now on
+            m_WarmInstancePtr = nullptr;
+
+            return instancePtr;
+        }
+
+        /// @copydoc sol::di::impl::IService::WarmUp
+        virtual void WarmUp(const Container& container) override
+        {
+            ResolutionStack::Guard guard(this, typeid(TService));
+
+            Lock lock(m_Mutex, typeid(TService));
+
+            m_WarmInstancePtr = GetOrCreateInstance(container);
         }
 
     private:
+        /// Mutex type
+        using Mutex = DiscardableMutex<ServiceMutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = DiscardableServiceLock<TThreadingPolicy::IsThreadSafe>;
+
+        /// Mutex, which guards the service instance pointer
+        Mutex m_Mutex;
+
         /// Pointer to the service instance
         ServiceWeakPtr m_ServicePtr;
 
+        /**
+         * @brief Pointer to the warmed up service instance, which
+         * keeps it alive until the service is resolved for the first time
+         */
+        ServicePtr m_WarmInstancePtr;
+
         /// Factory function
         Factory m_Factory;
+
+        /**
+         * @brief Gets the service instance if it exists or
+         * creates a new instance otherwise
+         * @warning The mutex must be locked by the caller
+         * @param[in] container DI container
+         * @returns pointer to the service instance
+         */
+        ServicePtr GetOrCreateInstance(const Container& container)
+        {
+            ServicePtr instancePtr = m_ServicePtr.lock();
+
+            if (instancePtr == nullptr)
+            {
+                instancePtr = InvokeFactory(m_Factory, container, *this);
+
+                solinject_req_assert(instancePtr != nullptr && "Factory should never return nullptr");
+
+                m_ServicePtr = instancePtr;
+            }
+
+            return instancePtr;
+        }
     }; // class SharedService
 } // sol::di::impl
@@ -21,45 +21,56 @@
 /// @file
 
 #pragma once
+#include <atomic>
+#include <typeinfo>
 #include "solinject/Defines.hpp"
+#include "solinject/Utils.hpp"
 #include "ServiceBase.hpp"
+#include "ServiceMutex.hpp"
+#include "Factory.hpp"
+#include "StartupRecorder.hpp"
 
 namespace sol::di::impl
 {
     /**
      * @brief Singleton DI service
-     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TService service type
+     * @tparam TFactory factory function type
+     * @tparam TServiceParents types, which the service is also resolvable as
      */
-    template<class TService, class...TServiceParents>
-    class SingletonService : 
-        public ServiceBase<TService>,
-        public ServiceBase<TServiceParents>...
+    template<
+        class TThreadingPolicy,
+        class TService,
+        class TFactory = typename IServiceTyped<TThreadingPolicy, TService>::Factory,
+        class...TServiceParents
+    >
+    class SingletonService :
+        public DIServiceBase<
+            TThreadingPolicy,
+            SingletonService<TThreadingPolicy, TService, TFactory, TServiceParents...>,
+            TService,
+            TServiceParents...
+        >
     {
-        static_assert(
-            std::conjunction_v<std::is_base_of<TServiceParents, TService>...>,
-            "The TServiceParents types must be derived from the TService type"
-        );
     public:
         /// Base of the @ref SingletonService class
-        using Base = ServiceBase<TService>;
+        using Base = DIServiceBase<TThreadingPolicy, SingletonService, TService, TServiceParents...>;
 
-        /// @copydoc sol::di::impl::ServiceBase<T>::Container
+        /// @copydoc sol::di::impl::DIServiceBase::Container
         using Container = typename Base::Container;
 
-        /// @copydoc sol::di::impl::ServiceBase<T>::ServicePtr
+        /// @copydoc sol::di::impl::DIServiceBase::ServicePtr
         using ServicePtr = typename Base::ServicePtr;
 
-        /// @copydoc sol::di::impl::ServiceBase<T>::Factory
-        using Factory = typename Base::Factory;
-
-        /// @copydoc sol::di::impl::IService::VoidPtr
-        using VoidPtr = typename IService::VoidPtr;
+        /// Factory function type
+        using Factory = TFactory;
 
         /**
          * @brief Constructor
          * @param service pointer to a service instance
          */
-        SingletonService(ServicePtr service) : m_ServicePtr(service)
+        SingletonService(ServicePtr service) : m_ServicePtr(service), m_IsCreated(true)
         {
         }
 
@@ -67,29 +78,123 @@ namespace sol::di::impl
          * @brief Constructor
          * @param factory factory function
          */
-        SingletonService(Factory factory) : m_Factory(factory), m_ServicePtr(nullptr)
+        SingletonService(Factory factory) : m_ServicePtr(nullptr), m_IsCreated(false), m_Factory(std::move(factory))
         {
         }
 
         virtual ~SingletonService() {}
 
-    protected:
-        /// @copydoc sol::di::impl::IService::GetServiceAsVoidPtr
-        virtual VoidPtr GetServiceAsVoidPtr(const Container& container) override
+        /// @copydoc sol::di::impl::IService::Lifetime
+        virtual ServiceLifetime Lifetime() const override
+        {
+            return ServiceLifetime::Singleton;
+        }
+
+        /// @copydoc sol::di::impl::IService::WarmUp
+        virtual void WarmUp(const Container& container) override
+        {
+            ResolveService(container);
+        }
+
+        /// @copydoc sol::di::impl::IService::GetDependencies
+        virtual bool GetDependencies(std::vector<TypeId>& dependencies) const override
+        {
+            if constexpr (HasDependencyList<Factory>)
+            {
+                m_Factory.GetDependencies(dependencies);
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        /**
+         * @brief Resolves the service and checks for circular dependencies
+         *
+         * Once the instance is created, it's returned without locking.
+         * Before that, only one thread executes the factory, other
+         * threads wait on @ref m_Mutex. The instance is then published
+         * through @ref m_IsCreated. If waiting would deadlock because
+         * of a circular dependency between services, which are created
+         * by different threads, an exception is thrown instead
+         * (see @ref ServiceMutex).
+         *
+         * @param[in] container DI container
+         * @returns pointer to the service instance
+         * @throws sol::di::exc::CircularDependencyException
+         */
+        ServicePtr ResolveService(const Container& container)
         {
-            if (m_ServicePtr == nullptr)
+            if (m_IsCreated.load(std::memory_order_acquire))
+                return m_ServicePtr;
+
+            ResolutionStack::Guard guard(this, typeid(TService));
+
+            Lock lock(m_Mutex, typeid(TService));
+
+            if (!m_IsCreated.load(std::memory_order_relaxed))
             {
-                m_ServicePtr = m_Factory(container);
+                m_ServicePtr = InvokeFactory(m_Factory, container, *this);
                 solinject_req_assert(m_ServicePtr != nullptr && "Factory should never return nullptr");
+
+                m_IsCreated.store(true, std::memory_order_release);
             }
 
-            return std::static_pointer_cast<void>(m_ServicePtr);
+            return m_ServicePtr;
+        }
+
+        /**
+         * @brief Resolves the service by reference
+         *
+         * Once the instance is created, no reference counter is touched.
+         *
+         * @param[in] container DI container
+         * @returns pointer to the service instance or `nullptr`
+         * if the factory returned `nullptr` (see @ref RegisteredService::Borrow())
+         * @throws sol::di::exc::CircularDependencyException
+         */
+        TService* BorrowInstance(const Container& container)
+        {
+            if (!m_IsCreated.load(std::memory_order_acquire))
+                ResolveService(container);
+
+            return m_ServicePtr.get();
+        }
+
+    protected:
+        /**
+         * @brief Destroys the service instance, so that
+         * the next resolution executes the factory again
+         * @warning Must not be called while the service
+         * may be resolved by other threads
+         */
+        void DestroyService()
+        {
+            m_IsCreated.store(false, std::memory_order_relaxed);
+            m_ServicePtr = nullptr;
         }
 
     private:
+        /// Mutex type
+        using Mutex = DiscardableMutex<ServiceMutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = DiscardableServiceLock<TThreadingPolicy::IsThreadSafe>;
+
+        /// Mutex, which guards the service instance creation
+        Mutex m_Mutex;
+
         /// Pointer to the service instance
         ServicePtr m_ServicePtr;
 
+        /**
+         * @brief Field, indicating if @ref m_ServicePtr has been
+         * created and may be read without locking the per-service mutex
+         */
+        std::atomic<bool> m_IsCreated;
+
         /// Factory function
         Factory m_Factory;
     }; // class SingletonService
@@ -0,0 +1,154 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "ServiceLifetime.hpp"
+
+namespace sol::di
+{
+    /**
+     * @brief Services, which were created during a container's startup
+     *
+     * A profile is recorded by a container (see
+     * @ref Container::StartRecording()) and may be saved to a file,
+     * so that the next run can create the same services in advance
+     * (see @ref Container::Prewarm()).
+     *
+     * Services are identified by the names of their types, so a profile
+     * is only valid for the same build of the program.
+     *
+     * @headerfile StartupProfile.hpp solinject.hpp
+     */
+    class StartupProfile
+    {
+    public:
+        /// Creation of a service
+        struct Entry
+        {
+            /// Name of the service type, as returned by `std::type_info::name()`
+            std::string serviceType;
+
+            /// Service lifetime
+            ServiceLifetime lifetime;
+
+            /// Time, spent in the service factory function
+            std::chrono::microseconds duration;
+        };
+
+        /**
+         * @brief Gets the entries in the order
+         * the services were created in
+         * @returns the entries
+         */
+        const std::vector<Entry>& Entries() const { return m_Entries; }
+
+        /**
+         * @brief Adds an entry
+         * @param entry the entry
+         */
+        void AddEntry(Entry entry)
+        {
+            m_Entries.push_back(std::move(entry));
+        }
+
+        /**
+         * @brief Writes the profile to a stream
+         *
+         * Each entry is written on a separate line as the lifetime,
+         * the duration in microseconds and the service type name.
+         *
+         * @param stream the stream
+         */
+        void Save(std::ostream& stream) const
+        {
+            stream << FileHeader << '\n';
+
+            for (const auto& entry : m_Entries)
+                stream << static_cast<int>(entry.lifetime) << ' '
+                    << entry.duration.count() << ' '
+                    << entry.serviceType << '\n';
+        }
+
+        /**
+         * @brief Reads a profile from a stream
+         * @param stream the stream
+         * @returns the profile
+         * @throws std::runtime_error if the stream doesn't contain a valid profile
+         */
+        static StartupProfile Load(std::istream& stream)
+        {
+            using namespace std::string_literals;
+
+            StartupProfile profile;
+            std::string line;
+
+            if (!std::getline(stream, line) || line != FileHeader)
+                throw std::runtime_error("Invalid startup profile header");
+
+            while (std::getline(stream, line))
+            {
+                if (line.empty())
+                    continue;
+
+                std::istringstream lineStream(line);
+
+                int lifetime;
+                long long duration;
+                Entry entry;
+
+                if (!(lineStream >> lifetime >> duration) ||
+                    lifetime < static_cast<int>(ServiceLifetime::Singleton) ||
+                    lifetime > static_cast<int>(ServiceLifetime::Scoped))
+                {
+                    throw std::runtime_error("Invalid startup profile entry: "s + line);
+                }
+
+                lineStream >> std::ws;
+                std::getline(lineStream, entry.serviceType);
+
+                if (entry.serviceType.empty())
+                    throw std::runtime_error("Invalid startup profile entry: "s + line);
+
+                entry.lifetime = static_cast<ServiceLifetime>(lifetime);
+                entry.duration = std::chrono::microseconds(duration);
+
+                profile.AddEntry(std::move(entry));
+            }
+
+            return profile;
+        }
+
+    private:
+        /// First line of a profile file
+        static constexpr const char* FileHeader = "solinject-startup-profile 1";
+
+        /// The entries
+        std::vector<Entry> m_Entries;
+    };
+}
@@ -0,0 +1,167 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <typeinfo>
+#include "ServiceLifetime.hpp"
+#include "StartupProfile.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Recorder of the singleton and shared services,
+     * which are created during a container's startup
+     *
+     * A container and all its scopes share the same recorder.
+     */
+    class StartupRecorder
+    {
+    public:
+        /// Clock type
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Starts recording
+         *
+         * The previously recorded entries are discarded.
+         *
+         * @param window duration of the recording
+         */
+        void Start(Clock::duration window)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            m_Profile = StartupProfile();
+            m_End.store(Clock::now() + window, std::memory_order_relaxed);
+            m_IsRecording.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @brief Tells if the recording is in progress
+         *
+         * The recording is stopped once the window is over,
+         * so later calls don't read the clock.
+         *
+         * @returns `true` if the recording is in progress, `false` otherwise
+         */
+        bool IsRecording()
+        {
+            if (!m_IsRecording.load(std::memory_order_acquire))
+                return false;
+
+            if (Clock::now() <= m_End.load(std::memory_order_relaxed))
+                return true;
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            // The recording may have been restarted meanwhile
+            if (Clock::now() > m_End.load(std::memory_order_relaxed))
+                m_IsRecording.store(false, std::memory_order_relaxed);
+
+            return m_IsRecording.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records a creation of a service, if it's a singleton
+         * or a shared service and the recording window isn't over yet
+         * @tparam TDIService DI service type
+         * @param diService the DI service
+         * @param start time, when the factory function was called
+         * @param end time, when the factory function returned
+         */
+        template <class TDIService>
+        void Record(const TDIService& diService, Clock::time_point start, Clock::time_point end)
+        {
+            ServiceLifetime lifetime = diService.Lifetime();
+
+            if (lifetime != ServiceLifetime::Singleton && lifetime != ServiceLifetime::Shared)
+                return;
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (start > m_End.load(std::memory_order_relaxed))
+            {
+                m_IsRecording.store(false, std::memory_order_relaxed);
+                return;
+            }
+
+            m_Profile.AddEntry({
+                diService.ServiceType().name(),
+                lifetime,
+                std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            });
+        }
+
+        /**
+         * @brief Gets the recorded profile
+         * @returns the recorded profile
+         */
+        StartupProfile GetProfile() const
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            return m_Profile;
+        }
+
+    private:
+        /// Mutex, which guards the fields below
+        mutable std::mutex m_Mutex;
+
+        /// The recorded profile
+        StartupProfile m_Profile;
+
+        /// End of the recording window
+        std::atomic<Clock::time_point> m_End = Clock::time_point();
+
+        /// Field, indicating if the recording is in progress
+        std::atomic<bool> m_IsRecording = false;
+    };
+
+    /**
+     * @brief Invokes a DI service's factory function and records
+     * the service creation, if the recording is in progress
+     * @tparam TFactory factory function type
+     * @tparam TContainer DI container type
+     * @tparam TDIService DI service type
+     * @param factory factory function
+     * @param[in] container DI container
+     * @param diService the DI service
+     * @returns pointer to the created service instance
+     */
+    template <class TFactory, class TContainer, class TDIService>
+    auto InvokeFactory(TFactory& factory, const TContainer& container, const TDIService& diService)
+    {
+        StartupRecorder* recorder = container.GetStartupRecorder();
+
+        if (recorder == nullptr || !recorder->IsRecording())
+            return factory(container);
+
+        auto start = StartupRecorder::Clock::now();
+        auto result = factory(container);
+
+        recorder->Record(diService, start, StartupRecorder::Clock::now());
+
+        return result;
+    }
+}
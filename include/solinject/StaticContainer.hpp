@@ -0,0 +1,279 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include "ServiceLifetime.hpp"
+#include "StaticRegistration.hpp"
+#include "StaticServiceStorage.hpp"
+#include "Container.hpp"
+
+namespace sol::di
+{
+    /**
+     * @brief Dependency Injection container, whose services
+     * are registered at compile time
+     *
+     * Each registration is a @ref StaticRegistration, usually one of
+     * @ref StaticSingleton, @ref StaticTransient and @ref StaticShared.
+     * The dependencies of a service must be registered before the
+     * service, so circular dependencies are impossible. If a service type
+     * is registered several times, the last registration is used.
+     *
+     * Singleton services are created when the container is constructed
+     * and resolving them is a member access. Transient services are
+     * constructed directly, without any factory functions. Resolving
+     * a service, which isn't registered, doesn't compile.
+     *
+     * The services may be exported to a @ref BasicContainer with
+     * @ref ExportTo(), so a dynamic container can add services
+     * (e.g. plugins), which depend on the static ones.
+     *
+     * @tparam TThreadingPolicy threading policy, which tells
+     * if the shared services are guarded by a mutex
+     * @tparam TRegistrations service registrations
+     * @headerfile StaticContainer.hpp solinject.hpp
+     */
+    template <class TThreadingPolicy, class...TRegistrations>
+    class BasicStaticContainer
+    {
+    public:
+        /// Threading policy of the container
+        using ThreadingPolicy = TThreadingPolicy;
+
+        /**
+         * @brief Pointer to an instance of a service
+         * @tparam T service type
+         */
+        template <class T>
+        using ServicePtr = std::shared_ptr<T>;
+
+        /**
+         * @brief Constructor
+         *
+         * Creates the singleton services in registration order.
+         */
+        BasicStaticContainer()
+        {
+            InitializeServices(std::index_sequence_for<TRegistrations...>());
+        }
+
+        /// Copy constructor (deleted)
+        BasicStaticContainer(const BasicStaticContainer&) = delete;
+
+        /// Copy-assignment operator (deleted)
+        BasicStaticContainer& operator=(const BasicStaticContainer&) = delete;
+
+        /**
+         * @brief Tells if a service is registered
+         * @tparam T service type
+         * @returns `true` if the service is registered, `false` otherwise
+         */
+        template <class T>
+        static constexpr bool IsRegistered()
+        {
+            return FindRegistration<T>() != NotFound;
+        }
+
+        /**
+         * @brief Resolves a required service
+         * @tparam T service type
+         * @returns Pointer to an instance of the service
+         */
+        template <class T>
+        ServicePtr<T> GetRequiredService() const
+        {
+            static_assert(IsRegistered<T>(), "The service must be registered in the static container");
+
+            return Resolve<FindRegistration<T>()>();
+        }
+
+        /**
+         * @brief Registers the services in a dynamic container
+         *
+         * Resolving a service from the dynamic container
+         * resolves it from this container.
+         *
+         * @warning This container must outlive @p container
+         * @tparam TContainerThreadingPolicy threading policy of the dynamic container
+         * @param container the dynamic container
+         * @throws sol::di::exc::ContainerFrozenException
+         */
+        template <class TContainerThreadingPolicy>
+        void ExportTo(BasicContainer<TContainerThreadingPolicy>& container) const
+        {
+            ExportServices(container, std::index_sequence_for<TRegistrations...>());
+        }
+
+    private:
+        /// Value, indicating that a service isn't registered
+        static constexpr size_t NotFound = sizeof...(TRegistrations);
+
+        /**
+         * @brief Registration type
+         * @tparam index registration index
+         */
+        template <size_t index>
+        using Registration = std::tuple_element_t<index, std::tuple<TRegistrations...>>;
+
+        /**
+         * @brief Service type of a registration
+         * @tparam index registration index
+         */
+        template <size_t index>
+        using Service = typename Registration<index>::Service;
+
+        /// Service instances storage
+        mutable std::tuple<
+            impl::StaticServiceStorage<TRegistrations::Lifetime, typename TRegistrations::Service, TThreadingPolicy>...
+        > m_Storage;
+
+        /**
+         * @brief Finds the last registration of a service
+         * @tparam T service type
+         * @returns the registration index or @ref NotFound
+         */
+        template <class T>
+        static constexpr size_t FindRegistration()
+        {
+            constexpr bool matches[] = { std::is_same_v<T, typename TRegistrations::Service>..., false };
+
+            size_t result = NotFound;
+
+            for (size_t i = 0; i < NotFound; i++)
+                if (matches[i])
+                    result = i;
+
+            return result;
+        }
+
+        /**
+         * @brief Tells if the dependencies of a service
+         * are registered before the service
+         * @tparam index registration index of the service
+         * @tparam TDependencies types of the dependencies
+         * @returns `true` if the dependencies are registered
+         * before the service, `false` otherwise
+         */
+        template <size_t index, class...TDependencies>
+        static constexpr bool AreRegisteredBefore(std::tuple<TDependencies...>*)
+        {
+            return ((FindRegistration<TDependencies>() < index) && ...);
+        }
+
+        /**
+         * @brief Resolves a service by its registration index
+         * @tparam index registration index
+         * @returns Pointer to an instance of the service
+         */
+        template <size_t index>
+        ServicePtr<Service<index>> Resolve() const
+        {
+            using TRegistration = Registration<index>;
+
+            if constexpr (TRegistration::Lifetime == ServiceLifetime::Singleton)
+                return std::get<index>(m_Storage).instance;
+            else if constexpr (TRegistration::Lifetime == ServiceLifetime::Transient)
+                return TRegistration::Create(*this);
+            else
+                return std::get<index>(m_Storage).GetOrCreate([this]() { return TRegistration::Create(*this); });
+        }
+
+        /**
+         * @brief Checks the registrations and creates the singleton services
+         * @tparam indices registration indices
+         */
+        template <size_t...indices>
+        void InitializeServices(std::index_sequence<indices...>)
+        {
+            (InitializeService<indices>(), ...);
+        }
+
+        /**
+         * @brief Checks a registration and creates
+         * the service if it's a singleton
+         * @tparam index registration index
+         */
+        template <size_t index>
+        void InitializeService()
+        {
+            using TRegistration = Registration<index>;
+
+            static_assert(
+                AreRegisteredBefore<index>(static_cast<typename TRegistration::Dependencies*>(nullptr)),
+                "The dependencies of a service must be registered in the static container before the service"
+            );
+
+            if constexpr (TRegistration::Lifetime == ServiceLifetime::Singleton)
+                std::get<index>(m_Storage).instance = TRegistration::Create(*this);
+        }
+
+        /**
+         * @brief Registers the services in a dynamic container
+         * @tparam TContainer dynamic container type
+         * @tparam indices registration indices
+         * @param container the dynamic container
+         */
+        template <class TContainer, size_t...indices>
+        void ExportServices(TContainer& container, std::index_sequence<indices...>) const
+        {
+            (ExportService<indices>(container), ...);
+        }
+
+        /**
+         * @brief Registers a service in a dynamic container
+         * @tparam index registration index
+         * @tparam TContainer dynamic container type
+         * @param container the dynamic container
+         */
+        template <size_t index, class TContainer>
+        void ExportService(TContainer& container) const
+        {
+            using TService = Service<index>;
+
+            if constexpr (Registration<index>::Lifetime == ServiceLifetime::Singleton)
+            {
+                container.template RegisterSingletonService<TService>(Resolve<index>());
+            }
+            else
+            {
+                // This container keeps track of the shared instances,
+                // so the dynamic container resolves them each time
+                container.template RegisterTransientService<TService>(
+                    [this](const TContainer&) { return Resolve<index>(); });
+            }
+        }
+    };
+
+    /**
+     * @brief Dependency Injection container, whose services are
+     * registered at compile time, with @ref DefaultThreadingPolicy
+     * @tparam TRegistrations service registrations
+     * @see BasicStaticContainer
+     * @headerfile StaticContainer.hpp solinject.hpp
+     */
+    template <class...TRegistrations>
+    using StaticContainer = BasicStaticContainer<DefaultThreadingPolicy, TRegistrations...>;
+}
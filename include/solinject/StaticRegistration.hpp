@@ -0,0 +1,113 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include "ServiceLifetime.hpp"
+
+namespace sol::di
+{
+    /**
+     * @brief Service registration for a @ref StaticContainer
+     *
+     * The implementation is constructed from the dependencies,
+     * which are resolved from the same @ref StaticContainer
+     * and passed as @ref std::shared_ptr arguments.
+     *
+     * @tparam lifetime service lifetime. Only singleton, transient
+     * and shared lifetimes are supported.
+     * @tparam TService service type
+     * @tparam TImplementation type of the service implementation
+     * @tparam TDependencies types of the services, which
+     * are injected into the implementation constructor
+     * @headerfile StaticRegistration.hpp solinject.hpp
+     */
+    template <ServiceLifetime lifetime, class TService, class TImplementation, class...TDependencies>
+    struct StaticRegistration
+    {
+        static_assert(
+            lifetime == ServiceLifetime::Singleton ||
+            lifetime == ServiceLifetime::Transient ||
+            lifetime == ServiceLifetime::Shared,
+            "Only singleton, transient and shared services can be registered in a static container"
+        );
+
+        static_assert(
+            std::is_base_of_v<TService, TImplementation>,
+            "The TImplementation type must be derived from the TService type"
+        );
+
+        /// Service lifetime
+        static constexpr ServiceLifetime Lifetime = lifetime;
+
+        /// Service type
+        using Service = TService;
+
+        /// Type of the service implementation
+        using Implementation = TImplementation;
+
+        /// Types of the injected services
+        using Dependencies = std::tuple<TDependencies...>;
+
+        /**
+         * @brief Creates an instance of the service
+         * @tparam TContainer container type
+         * @param[in] container the container to resolve the dependencies from
+         * @returns pointer to the created instance
+         */
+        template <class TContainer>
+        static std::shared_ptr<TService> Create(const TContainer& container)
+        {
+            return std::make_shared<TImplementation>(
+                container.template GetRequiredService<TDependencies>()...);
+        }
+    };
+
+    /**
+     * @brief Singleton service registration for a @ref StaticContainer
+     * @tparam TService service type
+     * @tparam TImplementation type of the service implementation
+     * @tparam TDependencies types of the injected services
+     */
+    template <class TService, class TImplementation, class...TDependencies>
+    using StaticSingleton = StaticRegistration<ServiceLifetime::Singleton, TService, TImplementation, TDependencies...>;
+
+    /**
+     * @brief Transient service registration for a @ref StaticContainer
+     * @tparam TService service type
+     * @tparam TImplementation type of the service implementation
+     * @tparam TDependencies types of the injected services
+     */
+    template <class TService, class TImplementation, class...TDependencies>
+    using StaticTransient = StaticRegistration<ServiceLifetime::Transient, TService, TImplementation, TDependencies...>;
+
+    /**
+     * @brief Shared service registration for a @ref StaticContainer
+     * @tparam TService service type
+     * @tparam TImplementation type of the service implementation
+     * @tparam TDependencies types of the injected services
+     */
+    template <class TService, class TImplementation, class...TDependencies>
+    using StaticShared = StaticRegistration<ServiceLifetime::Shared, TService, TImplementation, TDependencies...>;
+}
@@ -0,0 +1,102 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <mutex>
+#include "ServiceLifetime.hpp"
+#include "Utils.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Storage of a service instance in a static container
+     *
+     * Transient services don't need any storage.
+     *
+     * @tparam lifetime service lifetime
+     * @tparam TService service type
+     * @tparam TThreadingPolicy threading policy of the static container
+     */
+    template <ServiceLifetime lifetime, class TService, class TThreadingPolicy>
+    class StaticServiceStorage
+    {
+    };
+
+    /**
+     * @brief Storage of a singleton service instance in a static container
+     * @tparam TService service type
+     * @tparam TThreadingPolicy threading policy of the static container
+     */
+    template <class TService, class TThreadingPolicy>
+    class StaticServiceStorage<ServiceLifetime::Singleton, TService, TThreadingPolicy>
+    {
+    public:
+        /// Pointer to the service instance
+        std::shared_ptr<TService> instance;
+    };
+
+    /**
+     * @brief Storage of a shared service instance in a static container
+     * @tparam TService service type
+     * @tparam TThreadingPolicy threading policy of the static container
+     */
+    template <class TService, class TThreadingPolicy>
+    class StaticServiceStorage<ServiceLifetime::Shared, TService, TThreadingPolicy>
+    {
+    public:
+        /**
+         * @brief Gets the service instance, creating it if it doesn't exist
+         * @tparam TFactory factory function type
+         * @param factory factory function
+         * @returns pointer to the service instance
+         */
+        template <class TFactory>
+        std::shared_ptr<TService> GetOrCreate(TFactory&& factory)
+        {
+            Lock lock(m_Mutex);
+
+            std::shared_ptr<TService> instance = m_Instance.lock();
+
+            if (instance == nullptr)
+            {
+                instance = factory();
+                m_Instance = instance;
+            }
+
+            return instance;
+        }
+
+    private:
+        /// Mutex type
+        using Mutex = DiscardableMutex<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Lock type
+        using Lock = DiscardableLock<std::mutex, TThreadingPolicy::IsThreadSafe>;
+
+        /// Mutex, which guards the service instance pointer
+        Mutex m_Mutex;
+
+        /// Pointer to the service instance
+        std::weak_ptr<TService> m_Instance;
+    };
+}
@@ -0,0 +1,197 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+
+namespace sol::di
+{
+    /**
+     * @brief Threading policy, which guards a container
+     * with an exclusive mutex
+     * @see BasicContainer
+     */
+    struct ExclusiveMutexPolicy
+    {
+        /// Mutex type
+        using Mutex = std::mutex;
+
+        /// Field, indicating if the container may be used by several threads at once
+        static constexpr bool IsThreadSafe = true;
+
+        /**
+         * @brief Field, indicating if the container may be used only by
+         * the thread, which created it, until the container is frozen
+         */
+        static constexpr bool IsOwnedUntilFrozen = false;
+    };
+
+    /**
+     * @brief Threading policy, which guards a container
+     * with a recursive mutex
+     * @see BasicContainer
+     */
+    struct RecursiveMutexPolicy
+    {
+        /// Mutex type
+        using Mutex = std::recursive_mutex;
+
+        /// @copydoc ExclusiveMutexPolicy::IsThreadSafe
+        static constexpr bool IsThreadSafe = true;
+
+        /// @copydoc ExclusiveMutexPolicy::IsOwnedUntilFrozen
+        static constexpr bool IsOwnedUntilFrozen = false;
+    };
+
+    /**
+     * @brief Threading policy, which guards a container
+     * with a reader-writer lock, so concurrent resolutions
+     * don't block each other
+     * @see BasicContainer
+     */
+    struct SharedMutexPolicy
+    {
+        /// Mutex type
+        using Mutex = std::shared_mutex;
+
+        /// @copydoc ExclusiveMutexPolicy::IsThreadSafe
+        static constexpr bool IsThreadSafe = true;
+
+        /// @copydoc ExclusiveMutexPolicy::IsOwnedUntilFrozen
+        static constexpr bool IsOwnedUntilFrozen = false;
+    };
+
+    /**
+     * @brief Threading policy of a container, which is configured
+     * by a single thread and frozen before it's shared with others
+     *
+     * The container doesn't have a mutex at all. Until the container
+     * is frozen, only the thread, which created it, may register or
+     * resolve services. Other threads get
+     * @ref sol::di::exc::ContainerNotFrozenException instead of racing
+     * with it. Frozen containers resolve services without locking anyway.
+     *
+     * @see BasicContainer
+     * @see BasicContainer::Freeze()
+     */
+    struct LockFreeFrozenPolicy
+    {
+        /// Mutex type. `void` means that there's no mutex.
+        using Mutex = void;
+
+        /// @copydoc ExclusiveMutexPolicy::IsThreadSafe
+        static constexpr bool IsThreadSafe = true;
+
+        /// @copydoc ExclusiveMutexPolicy::IsOwnedUntilFrozen
+        static constexpr bool IsOwnedUntilFrozen = true;
+    };
+
+    /**
+     * @brief Threading policy of a container,
+     * which is used by a single thread
+     *
+     * Neither the container, nor its scopes lock their state.
+     *
+     * @see BasicContainer
+     */
+    struct NoThreadingPolicy
+    {
+        /// @copydoc LockFreeFrozenPolicy::Mutex
+        using Mutex = void;
+
+        /// @copydoc ExclusiveMutexPolicy::IsThreadSafe
+        static constexpr bool IsThreadSafe = false;
+
+        /// @copydoc ExclusiveMutexPolicy::IsOwnedUntilFrozen
+        static constexpr bool IsOwnedUntilFrozen = false;
+    };
+
+    /**
+     * @brief Threading policy of @ref Container
+     * @see SOLINJECT_NOTHREADSAFE
+     * @see SOLINJECT_SHARED_MUTEX
+     */
+    #if defined(SOLINJECT_NOTHREADSAFE)
+        using DefaultThreadingPolicy = NoThreadingPolicy;
+    #elif defined(SOLINJECT_SHARED_MUTEX)
+        using DefaultThreadingPolicy = SharedMutexPolicy;
+    #else
+        using DefaultThreadingPolicy = ExclusiveMutexPolicy;
+    #endif
+}
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Mutex of a container
+     *
+     * Satisfies the *SharedLockable* requirements, so it can be locked
+     * by @ref std::shared_lock, whatever the underlying mutex is.
+     * Exclusive mutexes are locked exclusively in shared mode too.
+     *
+     * @tparam TMutex the underlying mutex type
+     */
+    template <class TMutex>
+    class ContainerMutex
+    {
+    public:
+        /// Locks the mutex exclusively
+        void lock() { m_Mutex.lock(); }
+
+        /**
+         * @brief Tries to lock the mutex exclusively
+         * @returns `true` if the mutex is locked, `false` otherwise
+         */
+        bool try_lock() { return m_Mutex.try_lock(); }
+
+        /// Unlocks the exclusively locked mutex
+        void unlock() { m_Mutex.unlock(); }
+
+        /// Locks the mutex in shared mode
+        void lock_shared()
+        {
+            if constexpr (IsShared)
+                m_Mutex.lock_shared();
+            else
+                m_Mutex.lock();
+        }
+
+        /// Unlocks the mutex, locked in shared mode
+        void unlock_shared()
+        {
+            if constexpr (IsShared)
+                m_Mutex.unlock_shared();
+            else
+                m_Mutex.unlock();
+        }
+
+    private:
+        /// Field, indicating if the underlying mutex supports shared locking
+        static constexpr bool IsShared = std::is_same_v<TMutex, std::shared_mutex>
+            || std::is_same_v<TMutex, std::shared_timed_mutex>;
+
+        /// The underlying mutex
+        TMutex m_Mutex;
+    };
+}
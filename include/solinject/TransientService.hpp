@@ -22,56 +22,98 @@
 
 #pragma once
 #include <type_traits>
+#include <typeinfo>
 #include "solinject/Defines.hpp"
 #include "ServiceBase.hpp"
+#include "Factory.hpp"
 
 namespace sol::di::impl
 {
     /**
      * @brief Transient DI service
-     * @tparam T service type
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TService service type
+     * @tparam TFactory factory function type
+     * @tparam TServiceParents types, which the service is also resolvable as
      */
-    template<class TService, class...TServiceParents>
+    template<
+        class TThreadingPolicy,
+        class TService,
+        class TFactory = typename IServiceTyped<TThreadingPolicy, TService>::Factory,
+        class...TServiceParents
+    >
     class TransientService :
-        public ServiceBase<TService>,
-        public ServiceBase<TServiceParents>...
+        public DIServiceBase<
+            TThreadingPolicy,
+            TransientService<TThreadingPolicy, TService, TFactory, TServiceParents...>,
+            TService,
+            TServiceParents...
+        >
     {
-        static_assert(
-            std::conjunction_v<std::is_base_of<TServiceParents, TService>...>,
-            "The TServiceParents types must be derived from the TService type"
-        );
     public:
         /// Base of the @ref TransientService class
-        using Base = ServiceBase<TService>;
+        using Base = DIServiceBase<TThreadingPolicy, TransientService, TService, TServiceParents...>;
 
-        /// @copydoc ServiceBase<TService>::Container
+        /// @copydoc sol::di::impl::DIServiceBase::Container
         using Container = typename Base::Container;
 
-        /// @copydoc ServiceBase<TService>::ServicePtr
+        /// @copydoc sol::di::impl::DIServiceBase::ServicePtr
         using ServicePtr = typename Base::ServicePtr;
 
-        /// @copydoc ServiceBase<TService>::Factory
-        using Factory = typename Base::Factory;
-
-        /// @copydoc sol::di::impl::IService::VoidPtr
-        using VoidPtr = typename IService::VoidPtr;
+        /// Factory function type
+        using Factory = TFactory;
 
         /**
          * @brief Constructor
          * @param factory factory function
          */
-        TransientService(Factory factory) : m_Factory(factory)
+        TransientService(Factory factory) : m_Factory(std::move(factory))
+        {
+        }
+
+        /// @copydoc sol::di::impl::IService::Lifetime
+        virtual ServiceLifetime Lifetime() const override
+        {
+            return ServiceLifetime::Transient;
+        }
+
+        /// @copydoc sol::di::impl::IService::CompilePlan
+        virtual void CompilePlan(const Container& container) override
         {
+            if constexpr (HasResolutionPlan<Factory, Container>)
+                m_Factory.CompilePlan(container);
         }
 
-    protected:
-        virtual VoidPtr GetServiceAsVoidPtr(const Container& container) override
+        /// @copydoc sol::di::impl::IService::GetDependencies
+        virtual bool GetDependencies(std::vector<TypeId>& dependencies) const override
         {
-            auto service = m_Factory(container);
+            if constexpr (HasDependencyList<Factory>)
+            {
+                m_Factory.GetDependencies(dependencies);
+                return true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        /**
+         * @brief Creates a new instance of the service
+         * and checks for circular dependencies
+         * @param[in] container DI container
+         * @returns pointer to the created instance
+         * @throws sol::di::exc::CircularDependencyException
+         */
+        ServicePtr ResolveService(const Container& container)
+        {
+            ResolutionStack::Guard guard(this, typeid(TService));
+
+            ServicePtr service = m_Factory(container);
 
             solinject_req_assert(service != nullptr && "Factory should never return nullptr");
 
-            return std::static_pointer_cast<void>(service);
+            return service;
         }
 
     private:
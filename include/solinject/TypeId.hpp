@@ -0,0 +1,103 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <typeinfo>
+#include <typeindex>
+#include <unordered_map>
+
+namespace sol::di::impl
+{
+    /**
+     * @brief Dense integer identifier of a service type
+     *
+     * Type IDs are assigned sequentially, starting from zero,
+     * so they may be used as indices in contiguous arrays.
+     */
+    using TypeId = std::size_t;
+
+    /// Process-wide registry of the service type IDs
+    class TypeIdRegistry
+    {
+    public:
+        /**
+         * @brief Gets the ID of a type. If the type
+         * doesn't have an ID yet, a new one is assigned.
+         * @param type the type
+         * @returns the type ID
+         */
+        static TypeId GetTypeId(std::type_index type)
+        {
+            auto& registry = Instance();
+
+            std::lock_guard<std::mutex> lock(registry.m_Mutex);
+
+            auto nextId = registry.m_TypeIds.size();
+            return registry.m_TypeIds.try_emplace(type, nextId).first->second;
+        }
+
+    private:
+        /// Map of the assigned type IDs
+        std::unordered_map<std::type_index, TypeId> m_TypeIds;
+
+        /// Mutex, which guards @ref m_TypeIds
+        std::mutex m_Mutex;
+
+        /**
+         * @brief Gets the registry instance
+         * @returns the registry instance
+         */
+        static TypeIdRegistry& Instance()
+        {
+            static TypeIdRegistry instance;
+            return instance;
+        }
+    };
+
+    /**
+     * @brief Gets the ID of a type
+     * @param type the type
+     * @returns the type ID
+     */
+    inline TypeId GetTypeId(std::type_index type)
+    {
+        return TypeIdRegistry::GetTypeId(type);
+    }
+
+    /**
+     * @brief Gets the ID of a type
+     *
+     * The ID is looked up once and then cached,
+     * so subsequent calls don't touch the registry.
+     *
+     * @tparam T the type
+     * @returns the type ID
+     */
+    template <class T>
+    TypeId GetTypeId()
+    {
+        static const TypeId typeId = GetTypeId(std::type_index(typeid(T)));
+        return typeId;
+    }
+}
@@ -42,6 +42,14 @@ namespace sol::di::impl
          */
         template<class...TArgs>
         Empty(const TArgs&...args) {}
+
+        /**
+         * @brief Destructor
+         *
+         * It's user-provided, so discarded locks aren't reported
+         * as unused variables.
+         */
+        ~Empty() {}
     };
 
     /// @brief Adds elements of a vector to the end of the other vector
@@ -0,0 +1,101 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/// @file
+
+#pragma once
+#include <memory>
+#include <utility>
+#include "ServiceBase.hpp"
+
+namespace sol::di::impl
+{
+    /**
+     * @brief DI service, which stores a value of the service type inline
+     *
+     * The value is not wrapped into a @ref std::shared_ptr of its own.
+     * Resolving it by reference doesn't touch any reference counter,
+     * while resolving it as a @ref std::shared_ptr shares the ownership
+     * of the DI service itself.
+     *
+     * @tparam TThreadingPolicy threading policy of the DI container
+     * @tparam TService service type
+     */
+    template <class TThreadingPolicy, class TService>
+    class ValueService :
+        public DIServiceBase<TThreadingPolicy, ValueService<TThreadingPolicy, TService>, TService>,
+        public std::enable_shared_from_this<ValueService<TThreadingPolicy, TService>>
+    {
+    public:
+        /// Base of the @ref ValueService class
+        using Base = DIServiceBase<TThreadingPolicy, ValueService, TService>;
+
+        /// @copydoc sol::di::impl::DIServiceBase::Container
+        using Container = typename Base::Container;
+
+        /// @copydoc sol::di::impl::DIServiceBase::ServicePtr
+        using ServicePtr = typename Base::ServicePtr;
+
+        /**
+         * @brief Constructor
+         * @param value the value
+         */
+        ValueService(TService value) : m_Value(std::move(value))
+        {
+        }
+
+        virtual ~ValueService() {}
+
+        /**
+         * @copydoc sol::di::impl::IService::Lifetime
+         *
+         * The value lives as long as the container, like a singleton.
+         */
+        virtual ServiceLifetime Lifetime() const override
+        {
+            return ServiceLifetime::Singleton;
+        }
+
+        /**
+         * @brief Resolves the service
+         * @param[in] container DI container
+         * @returns pointer to the value, which shares
+         * the ownership of the DI service
+         */
+        ServicePtr ResolveService(const Container& container)
+        {
+            return ServicePtr(this->shared_from_this(), &m_Value);
+        }
+
+        /**
+         * @brief Resolves the service by reference
+         * @param[in] container DI container
+         * @returns pointer to the value
+         */
+        TService* BorrowInstance(const Container& container)
+        {
+            return &m_Value;
+        }
+
+    private:
+        /// The value
+        TService m_Value;
+    };
+}
@@ -106,6 +106,17 @@ namespace sol::di::test
 
     int SameInstanceTestClass::NextId = 0;
 
+    class DependencyHolderTestClass
+    {
+    public:
+        DependencyHolderTestClass(std::shared_ptr<SameInstanceTestClass> dependency) :
+            m_Dependency(dependency) { }
+
+        std::shared_ptr<SameInstanceTestClass> Dependency() { return m_Dependency; }
+    private:
+        std::shared_ptr<SameInstanceTestClass> m_Dependency;
+    };
+
     class CircularDependencyTestClassB;
 
     class CircularDependencyTestClassA
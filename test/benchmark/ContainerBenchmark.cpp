@@ -0,0 +1,193 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <solinject.hpp>
+#include <solinject-macros.hpp>
+
+#include "TestClasses.hpp"
+
+using namespace sol::di;
+
+/// Number of resolutions, performed by each thread
+constexpr int ResolutionsPerThread = 200000;
+
+/**
+ * @brief Measures throughput of resolving services
+ * from a container, which is not frozen
+ * @tparam TContainer DI container type
+ * @param container the container
+ * @param threadCount number of resolving threads
+ * @returns the number of resolutions per second
+ */
+template <class TContainer>
+double MeasureThroughput(const TContainer& container, int threadCount)
+{
+    using namespace test;
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<int> readyCount = 0;
+    std::atomic<bool> isStarted = false;
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < threadCount; i++)
+        threads.push_back(std::thread([&]() {
+            readyCount++;
+
+            while (!isStarted)
+                std::this_thread::yield();
+
+            for (int j = 0; j < ResolutionsPerThread; j++)
+            {
+                if (j % 2 == 0)
+                    container.template GetRequiredService<TestA>();
+                else
+                    container.template GetRequiredService<TestB>();
+            }
+        }));
+
+    while (readyCount != threadCount)
+        std::this_thread::yield();
+
+    auto start = Clock::now();
+    isStarted = true;
+
+    for (auto& thread : threads)
+        thread.join();
+
+    std::chrono::duration<double> duration = Clock::now() - start;
+
+    return double(threadCount) * ResolutionsPerThread / duration.count();
+}
+
+/**
+ * @brief Container, which holds one recursive mutex across each
+ * whole resolution, including the factories, like the container
+ * did before the threading policies were added
+ */
+class GloballyLockedContainer
+{
+public:
+    /**
+     * @brief Gets the underlying container
+     * @returns the underlying container
+     */
+    BasicContainer<RecursiveMutexPolicy>& Get() { return m_Container; }
+
+    /**
+     * @brief Resolves a required service with the mutex locked
+     * @tparam T service type
+     * @returns pointer to an instance of the service
+     */
+    template <class T>
+    std::shared_ptr<T> GetRequiredService() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_Mutex);
+        return m_Container.template GetRequiredService<T>();
+    }
+
+private:
+    /// The underlying container
+    BasicContainer<RecursiveMutexPolicy> m_Container;
+
+    /// Mutex, which is held across each resolution
+    mutable std::recursive_mutex m_Mutex;
+};
+
+/**
+ * @brief Registers the benchmarked services
+ * @tparam TThreadingPolicy the threading policy
+ * @param container the container
+ */
+template <class TThreadingPolicy>
+void RegisterServices(BasicContainer<TThreadingPolicy>& container)
+{
+    using namespace test;
+
+    RegisterSingletonService(container, TestA);
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+}
+
+/**
+ * @brief Measures throughput of a container from 1 to 64 threads
+ * @tparam TContainer DI container type
+ * @param title the benchmark title
+ * @param container the container
+ */
+template <class TContainer>
+void PrintThroughput(const char* title, const TContainer& container)
+{
+    std::cout << title << std::endl;
+    std::cout << std::setw(8) << "Threads" << std::setw(20) << "Resolutions/s" << std::endl;
+
+    for (int threadCount = 1; threadCount <= 64; threadCount *= 2)
+    {
+        std::cout << std::setw(8) << threadCount
+            << std::setw(20) << std::fixed << std::setprecision(0)
+            << MeasureThroughput(container, threadCount) << std::endl;
+    }
+
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Measures throughput of a container
+ * with a threading policy from 1 to 64 threads
+ * @tparam TThreadingPolicy the threading policy
+ * @param policyName the threading policy name
+ * @param useResolutionCache `true` to enable the thread-local resolution cache
+ */
+template <class TThreadingPolicy>
+void RunBenchmark(const char* policyName, bool useResolutionCache = false)
+{
+    BasicContainer<TThreadingPolicy> container;
+    container.EnableResolutionCache(useResolutionCache);
+
+    RegisterServices(container);
+
+    std::string title = std::string("Threading policy: ") + policyName
+        + (useResolutionCache ? ", resolution cache" : "");
+
+    PrintThroughput(title.c_str(), container);
+}
+
+int main()
+{
+    {
+        GloballyLockedContainer container;
+        RegisterServices(container.Get());
+
+        PrintThroughput("Baseline: global recursive mutex, held across resolution", container);
+    }
+
+    RunBenchmark<RecursiveMutexPolicy>("recursive mutex");
+    RunBenchmark<ExclusiveMutexPolicy>("exclusive mutex");
+    RunBenchmark<SharedMutexPolicy>("shared mutex");
+    RunBenchmark<ExclusiveMutexPolicy>("exclusive mutex", true);
+
+    return 0;
+}
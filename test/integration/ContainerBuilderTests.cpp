@@ -137,9 +137,59 @@ void ItHandlesInterfaceToInterfaceRegistration()
     assert(d3 != nullptr);
 }
 
+void ItResolvesServiceAsEachOfItsBases()
+{
+    using namespace test;
+
+    class IFirst
+    {
+    public:
+        virtual ~IFirst() {}
+        virtual int First() const = 0;
+    };
+
+    class ISecond
+    {
+    public:
+        virtual ~ISecond() {}
+        virtual int Second() const = 0;
+    };
+
+    class Both : public IFirst, public ISecond
+    {
+    public:
+        int First() const override { return 1; }
+        int Second() const override { return 2; }
+    };
+
+    ContainerBuilder builder;
+
+    builder.template RegisterInterface<IFirst>("IFirst");
+    builder.template RegisterInterface<ISecond>("ISecond");
+    builder.template RegisterService<Both, IFirst, ISecond>("Both", FACTORY(Both));
+
+    Configuration configuration({
+        ConfigurationItem("IFirst", "Both", ServiceLifetime::None),
+        ConfigurationItem("ISecond", "Both", ServiceLifetime::None),
+        ConfigurationItem("Both", ServiceLifetime::Singleton)
+    });
+
+    auto container = builder.BuildContainer(configuration);
+
+    auto both = container.template GetRequiredService<Both>();
+    auto first = container.template GetRequiredService<IFirst>();
+    auto second = container.template GetRequiredService<ISecond>();
+
+    assert(first.get() == static_cast<IFirst*>(both.get()));
+    assert(second.get() == static_cast<ISecond*>(both.get()));
+    assert(first->First() == 1);
+    assert(second->Second() == 2);
+}
+
 void RunTests()
 {
     ItBuildsContainer();
     ItHandlesMultipleImplementationsOfTheSameInterface();
     ItHandlesInterfaceToInterfaceRegistration();
+    ItResolvesServiceAsEachOfItsBases();
 }
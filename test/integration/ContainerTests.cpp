@@ -21,6 +21,10 @@
 #include <iostream>
 #include <vector>
 #include <thread>
+#include <atomic>
+#include <future>
+#include <memory_resource>
+#include <sstream>
 #include <assert.h>
 #include <solinject.hpp>
 #include <solinject-macros.hpp>
@@ -29,6 +33,220 @@
 
 using namespace sol::di;
 
+void ItRejectsRegistrationInFrozenContainer()
+{
+    using namespace test;
+    using namespace exc;
+
+    Container container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterScopedService(container, TestB, FROM_DI(TestA));
+
+    container.Freeze();
+
+    bool exceptionThrown = false;
+
+    try
+    {
+        RegisterSingletonService(container, TestA);
+    }
+    catch (const ContainerFrozenException& ex)
+    {
+        exceptionThrown = true;
+    }
+
+    auto scope = container.CreateScope();
+    RegisterTransientService(scope, TestC, FROM_DI(TestA), FROM_DI(TestB));
+
+    assert(exceptionThrown);
+    assert(container.IsFrozen());
+    assert(!scope.IsFrozen());
+    assert(container.template GetRequiredService<TestA>() != nullptr);
+    assert(scope.template GetRequiredService<TestC>() != nullptr);
+}
+
+void ItHandlesMultithreadedAccessToFrozenContainerCorrectly()
+{
+    using namespace sol::di::test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+    RegisterSharedService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+    RegisterSingletonInterface(container, ITestD, TestD, FROM_DI(TestC));
+    RegisterSingletonService(container, SameInstanceTestClass);
+
+    container.Freeze();
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 50; i++)
+        threads.push_back(std::thread([&]() {
+            for (int j = 0; j < 50; j++)
+            {
+                auto d = container.template GetRequiredService<ITestD>();
+                auto c = container.template GetRequiredService<TestC>();
+                auto instance = container.template GetRequiredService<SameInstanceTestClass>();
+
+                assert(d != nullptr);
+                assert(c != nullptr);
+                assert(instance->Id() == 0);
+            }
+        }));
+
+    for (auto& thread : threads)
+        if (thread.joinable())
+            thread.join();
+}
+
+void ItDoesNotBlockOtherServicesWhileSingletonIsBeingCreated()
+{
+    using namespace test;
+
+    Container container;
+
+    std::promise<void> factoryStarted;
+    std::promise<void> otherServiceResolved;
+    auto otherServiceResolvedFuture = otherServiceResolved.get_future();
+
+    container.template RegisterSingletonService<TestA>([&](const Container&)
+    {
+        factoryStarted.set_value();
+        otherServiceResolvedFuture.wait();
+
+        return std::make_shared<TestA>();
+    });
+
+    RegisterSingletonService(container, SameInstanceTestClass);
+
+    std::thread thread([&]() {
+        auto a = container.template GetRequiredService<TestA>();
+        assert(a != nullptr);
+    });
+
+    factoryStarted.get_future().wait();
+
+    auto instance = container.template GetRequiredService<SameInstanceTestClass>();
+    otherServiceResolved.set_value();
+
+    thread.join();
+
+    assert(instance != nullptr);
+}
+
+void ItDetectsCircularDependencyBetweenThreads()
+{
+    using namespace test;
+    using namespace exc;
+
+    Container container;
+
+    std::atomic<int> startedFactoryCount = 0;
+
+    auto waitForBothFactories = [&startedFactoryCount]()
+    {
+        startedFactoryCount++;
+
+        while (startedFactoryCount < 2)
+            std::this_thread::yield();
+    };
+
+    container.template RegisterSingletonService<CircularDependencyTestClassA>([&](const Container& c)
+    {
+        waitForBothFactories();
+
+        return std::make_shared<CircularDependencyTestClassA>(
+            c.template GetRequiredService<CircularDependencyTestClassB>());
+    });
+
+    container.template RegisterSingletonService<CircularDependencyTestClassB>([&](const Container& c)
+    {
+        waitForBothFactories();
+
+        return std::make_shared<CircularDependencyTestClassB>(
+            c.template GetRequiredService<CircularDependencyTestClassA>());
+    });
+
+    std::atomic<bool> exceptionThrownA = false;
+    std::atomic<bool> exceptionThrownB = false;
+
+    std::thread thread([&]() {
+        try
+        {
+            container.template GetRequiredService<CircularDependencyTestClassA>();
+        }
+        catch (const CircularDependencyException& ex)
+        {
+            exceptionThrownA = true;
+        }
+    });
+
+    try
+    {
+        container.template GetRequiredService<CircularDependencyTestClassB>();
+    }
+    catch (const CircularDependencyException& ex)
+    {
+        exceptionThrownB = true;
+    }
+
+    thread.join();
+
+    assert(exceptionThrownA);
+    assert(exceptionThrownB);
+}
+
+void ItRecoversFromThrowingFactory()
+{
+    using namespace test;
+    using namespace exc;
+
+    Container container;
+
+    bool shouldThrow = true;
+
+    container.template RegisterSingletonService<TestA>([&](const Container&)
+    {
+        if (shouldThrow)
+            throw std::runtime_error("Factory failed");
+
+        return std::make_shared<TestA>();
+    });
+
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+
+    bool factoryExceptionThrown = false;
+    bool circularDependencyExceptionThrown = false;
+
+    try
+    {
+        container.template GetRequiredService<TestB>();
+    }
+    catch (const std::runtime_error& ex)
+    {
+        factoryExceptionThrown = true;
+    }
+
+    shouldThrow = false;
+
+    try
+    {
+        auto b = container.template GetRequiredService<TestB>();
+        assert(b != nullptr);
+    }
+    catch (const CircularDependencyException& ex)
+    {
+        circularDependencyExceptionThrown = true;
+    }
+
+    assert(factoryExceptionThrown);
+    assert(!circularDependencyExceptionThrown);
+}
+
 void RunTests();
 
 int main()
@@ -194,40 +412,1240 @@ void ItAllowsCreatingScopeOfAScope()
     assert(instance1->Id() != instance1_1->Id());
 }
 
-void ItReturnsMultipleRegisteredServices()
+void ItCreatesSingleThreadedScopes()
+{
+    using namespace test;
+
+    Container container;
+    RegisterSingletonService(container, TestA);
+    container.template RegisterScopedService<TestB>(ARENA_FACTORY(TestB, FROM_DI(TestA)));
+
+    std::vector<std::thread> threads;
+
+    // Each thread uses its own scopes
+    for (int i = 0; i < 4; i++)
+        threads.push_back(std::thread([&container]() {
+            for (int j = 0; j < 50; j++)
+            {
+                auto scope = container.CreateScope(ScopeThreading::SingleThreaded);
+                RegisterScopedService(scope, TestC, FROM_DI(TestA), FROM_DI(TestB));
+
+                auto b = scope.template GetRequiredService<TestB>();
+                assert(b == scope.template GetRequiredService<TestB>());
+
+                auto scope1 = scope.CreateScope(ScopeThreading::SingleThreaded);
+                assert(scope1.template GetRequiredService<TestC>() != nullptr);
+                assert(scope1.template GetRequiredService<TestB>() == b);
+
+                auto movedScope = std::move(scope);
+                assert(movedScope.template GetRequiredService<TestB>() == b);
+
+                // The instance is allocated from the scope's arena
+                b.reset();
+            }
+        }));
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+template <class TThreadingPolicy>
+void TestThreadingPolicy(bool isThreadSafe)
+{
+    using namespace test;
+
+    BasicContainer<TThreadingPolicy> container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+    RegisterScopedService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+
+    auto resolve = [&container]() {
+        auto scope = container.CreateScope();
+
+        assert(scope.template GetRequiredService<TestC>() == scope.template GetRequiredService<TestC>());
+        assert(container.template GetRequiredService<TestA>() == scope.template GetRequiredService<TestA>());
+    };
+
+    resolve();
+
+    if (!isThreadSafe)
+        return;
+
+    container.Freeze();
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 4; i++)
+        threads.push_back(std::thread([&resolve]() {
+            for (int j = 0; j < 50; j++)
+                resolve();
+        }));
+
+    for (auto& thread : threads)
+        thread.join();
+
+    BasicContainer<TThreadingPolicy> moved = std::move(container);
+    assert(moved.template GetRequiredService<TestB>() != nullptr);
+}
+
+void ItSupportsThreadingPolicies()
+{
+    TestThreadingPolicy<ExclusiveMutexPolicy>(true);
+    TestThreadingPolicy<RecursiveMutexPolicy>(true);
+    TestThreadingPolicy<SharedMutexPolicy>(true);
+    TestThreadingPolicy<LockFreeFrozenPolicy>(true);
+    TestThreadingPolicy<NoThreadingPolicy>(false);
+}
+
+void ItRequiresLockFreeFrozenContainersToBeFrozenBeforeSharing()
+{
+    using namespace test;
+    using namespace exc;
+
+    BasicContainer<LockFreeFrozenPolicy> container;
+
+    RegisterSingletonService(container, TestA);
+
+    bool resolutionRejected = false;
+    bool registrationRejected = false;
+
+    std::thread([&]() {
+        try
+        {
+            container.template GetRequiredService<TestA>();
+        }
+        catch (const ContainerNotFrozenException& ex)
+        {
+            resolutionRejected = true;
+        }
+
+        try
+        {
+            RegisterTransientService(container, TestB, FROM_DI(TestA));
+        }
+        catch (const ContainerNotFrozenException& ex)
+        {
+            registrationRejected = true;
+        }
+    }).join();
+
+    assert(resolutionRejected);
+    assert(registrationRejected);
+
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+    container.Freeze();
+
+    std::shared_ptr<TestB> b;
+
+    std::thread([&]() {
+        b = container.template GetRequiredService<TestB>();
+    }).join();
+
+    assert(b != nullptr);
+}
+
+void ItBuildsScopedServicesOnFirstResolution()
 {
     using namespace test;
 
+    using Builder = impl::ScopedServiceBuilder<DefaultThreadingPolicy, SameInstanceTestClass>;
+
+    class CountingBuilder : public Builder
+    {
+    public:
+        CountingBuilder(Factory factory, int& buildCount) :
+            Builder(factory),
+            m_BuildCount(buildCount)
+        {
+        }
+
+        AbstractDIServicePtr BuildDIService() const override
+        {
+            m_BuildCount++;
+            return Builder::BuildDIService();
+        }
+
+    private:
+        int& m_BuildCount;
+    };
+
     SameInstanceTestClass::ResetIds();
 
+    int buildCount = 0;
+
     Container container;
 
-    RegisterSingletonService(container, SameInstanceTestClass, 1);
-    RegisterSingletonService(container, SameInstanceTestClass, 2);
-    RegisterSingletonService(container, SameInstanceTestClass, 3);
+    container.RegisterScopedServiceBuilder(
+        typeid(SameInstanceTestClass),
+        std::make_shared<CountingBuilder>(FACTORY(SameInstanceTestClass), buildCount)
+    );
 
-    auto instances = container.template GetServices<SameInstanceTestClass>();
+    auto scope = container.CreateScope();
+    assert(buildCount == 0);
 
-    assert(instances[0]->Id() == 1);
-    assert(instances[1]->Id() == 2);
-    assert(instances[2]->Id() == 3);
+    RegisterScopedService(container, SameInstanceTestClass);
+
+    auto instance1 = scope.template GetRequiredService<SameInstanceTestClass>();
+    auto instances = scope.template GetServices<SameInstanceTestClass>();
+
+    assert(buildCount == 1);
+    assert(instances.size() == 1);
+    assert(instances[0] == instance1);
+
+    RegisterSingletonService(scope, SameInstanceTestClass);
+    assert(scope.template GetServices<SameInstanceTestClass>()[0] == instance1);
+
+    auto scope2 = container.CreateScope();
+    assert(scope2.template GetServices<SameInstanceTestClass>().size() == 2);
+    assert(buildCount == 2);
 }
 
-void ItReturnsLastRegisteredService()
+void ItResolvesMultipleServicesAtOnce()
 {
     using namespace test;
 
-    SameInstanceTestClass::ResetIds();
+    Container container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterSingletonService(container, TestB, FROM_DI(TestA));
+    RegisterTransientService(container, TestC, FROM_DI_ALL(TestA, TestB));
+
+    auto [a, b] = container.template GetRequiredServices<TestA, TestB>();
+
+    assert(a == container.template GetRequiredService<TestA>());
+    assert(b == container.template GetRequiredService<TestB>());
+
+    auto c = container.template GetRequiredService<TestC>();
+    assert(c != nullptr);
+
+    // Expanded arguments may be mixed with regular ones
+    auto scope = container.CreateScope();
+    scope.template RegisterTransientService<TestC>(
+        ARENA_FACTORY(TestC, FROM_DI(TestA), FROM_DI_ALL(TestB)));
+
+    assert(scope.template GetRequiredService<TestC>() != nullptr);
+
+    bool isThrown = false;
+
+    try
+    {
+        container.template GetRequiredServices<TestA, ITestD>();
+    }
+    catch (const exc::ServiceNotRegisteredException&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+}
+
+void ItIteratesOverMultipleServicesWithoutAllocating()
+{
+    using namespace test;
 
     Container container;
 
-    RegisterSingletonService(container, SameInstanceTestClass, 1);
-    RegisterSingletonService(container, SameInstanceTestClass, 2);
-    RegisterSingletonService(container, SameInstanceTestClass, 3);
+    RegisterSingletonInterface(container, ITestD, TestD3);
+    RegisterSingletonInterface(container, ITestD, TestD3);
 
-    auto service = container.template GetRequiredService<SameInstanceTestClass>();
+    auto expected = container.template GetServices<ITestD>();
 
-    assert(service->Id() == 3);
+    std::vector<std::shared_ptr<ITestD>> visited;
+    container.template ForEachService<ITestD>([&visited](const std::shared_ptr<ITestD>& service)
+    {
+        visited.push_back(service);
+    });
+
+    assert(visited == expected);
+
+    auto view = container.template GetServicesView<ITestD>();
+    assert(view.IsCached());
+
+    visited.clear();
+    view.ForEach(container, [&visited](const std::shared_ptr<ITestD>& service)
+    {
+        visited.push_back(service);
+    });
+
+    assert(visited == expected);
+
+    // A view of non-singleton services resolves them each time
+    RegisterTransientInterface(container, ITestD, TestD3);
+
+    auto transientView = container.template GetServicesView<ITestD>();
+    assert(!transientView.IsCached());
+
+    size_t count = 0;
+    transientView.ForEach(container, [&count](const std::shared_ptr<ITestD>&) { count++; });
+
+    assert(count == 3);
+
+    // The cached view ignores later registrations
+    count = 0;
+    view.ForEach(container, [&count](const std::shared_ptr<ITestD>&) { count++; });
+
+    assert(count == 2);
+
+    // A view of a type without registrations sees later registrations
+    auto emptyView = container.template GetServicesView<TestA>();
+    assert(!emptyView.IsCached());
+
+    RegisterSingletonService(container, TestA);
+
+    count = 0;
+    emptyView.ForEach(container, [&count](const std::shared_ptr<TestA>&) { count++; });
+
+    assert(count == 1);
+}
+
+void ItInjectsConstructorDependencies()
+{
+    using namespace test;
+
+    Container container;
+
+    container.template RegisterSingletonService<TestA>(Inject<>());
+    container.template RegisterSharedService<TestB>(Inject<TestA>());
+    container.template RegisterTransientService<TestC>(Inject<TestA, TestB>());
+    container.template RegisterScopedService<ITestD, TestD>(Inject<TestC>());
+
+    auto a = container.template GetRequiredService<TestA>();
+    assert(a == container.template GetRequiredService<TestA>());
+
+    auto b = container.template GetRequiredService<TestB>();
+    assert(b == container.template GetRequiredService<TestB>());
+
+    auto c = container.template GetRequiredService<TestC>();
+    assert(c != container.template GetRequiredService<TestC>());
+
+    auto scope = container.CreateScope();
+    auto d = scope.template GetRequiredService<ITestD>();
+
+    assert(dynamic_cast<TestD*>(d.get()) != nullptr);
+    assert(d == scope.template GetRequiredService<ITestD>());
+}
+
+void ItResolvesNestedServicesThroughResolutionContext()
+{
+    using namespace test;
+
+    Container container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+    RegisterTransientService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+    RegisterTransientInterface(container, ITestD, TestD, FROM_DI(TestC));
+
+    auto scope = container.CreateScope();
+
+    const Container* contextContainer = nullptr;
+
+    scope.template RegisterTransientService<TestE>(
+        [&contextContainer](const ResolutionContext& c)
+        {
+            contextContainer = &c.GetContainer();
+
+            // The nested factories reuse the context's registered services
+            return std::make_shared<TestE>(c.template GetRequiredService<ITestD>());
+        }
+    );
+
+    assert(scope.template GetRequiredService<TestE>() != nullptr);
+    assert(contextContainer == &scope);
+
+    // The container is not locked while the context is alive
+    {
+        ResolutionContext context(container);
+        container.template RegisterTransientService<TestE>(FACTORY(TestE, FROM_DI(ITestD)));
+        assert(context.template GetService<TestE>() == nullptr);
+    }
+
+    assert(container.template GetRequiredService<TestE>() != nullptr);
+}
+
+void ItCachesResolvedServicesPerThread()
+{
+    using namespace test;
+
+    Container container;
+    container.EnableResolutionCache();
+
+    auto a1 = std::make_shared<TestA>();
+    container.template RegisterSingletonService<TestA>(a1);
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+    RegisterScopedService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+
+    assert(container.template GetRequiredService<TestA>() == a1);
+    assert(container.template GetRequiredService<TestA>() == a1);
+
+    // Transient services are not cached
+    assert(container.template GetRequiredService<TestB>() != container.template GetRequiredService<TestB>());
+
+    // Registering a service invalidates the cache
+    auto a2 = std::make_shared<TestA>();
+    container.template RegisterSingletonService<TestA>(a2);
+    assert(container.template GetRequiredService<TestA>() == a2);
+
+    // Scoped services are cached per scope
+    std::shared_ptr<TestC> c1;
+
+    {
+        auto scope1 = container.CreateScope();
+        assert(scope1.IsResolutionCacheEnabled());
+
+        c1 = scope1.template GetRequiredService<TestC>();
+        assert(scope1.template GetRequiredService<TestC>() == c1);
+    }
+
+    auto scope2 = container.CreateScope();
+    assert(scope2.template GetRequiredService<TestC>() != c1);
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 4; i++)
+        threads.push_back(std::thread([&container, i]() {
+            for (int j = 0; j < 50; j++)
+            {
+                if (i == 0)
+                    container.template RegisterSingletonService<TestA>(std::make_shared<TestA>());
+
+                assert(container.template GetRequiredService<TestA>() != nullptr);
+            }
+        }));
+
+    for (auto& thread : threads)
+        thread.join();
+
+    auto a3 = std::make_shared<TestA>();
+    container.template RegisterSingletonService<TestA>(a3);
+    assert(container.template GetRequiredService<TestA>() == a3);
+
+    container.EnableResolutionCache(false);
+    assert(container.template GetRequiredService<TestA>() == a3);
+
+    // Resolving from several containers in turn doesn't evict their entries
+    using Cache = impl::ResolutionCache<TestA>;
+
+    int container1 = 0;
+    int container2 = 0;
+    auto generation1 = impl::NextContainerGeneration();
+    auto generation2 = impl::NextContainerGeneration();
+
+    Cache::Store(&container1, generation1, a1);
+    Cache::Store(&container2, generation2, a2);
+
+    assert(Cache::Find(&container1, generation1) == a1);
+    assert(Cache::Find(&container2, generation2) == a2);
+    assert(Cache::Find(&container1, generation2) == nullptr);
+
+    // The cache doesn't keep the instances alive
+    Cache::Store(&container1, generation1, std::make_shared<TestA>());
+    assert(Cache::Find(&container1, generation1) == nullptr);
+}
+
+void ItResolvesServicesByReference()
+{
+    using namespace test;
+
+    struct Config
+    {
+        int port;
+        bool isVerbose;
+    };
+
+    std::shared_ptr<Config> config;
+
+    {
+        Container container;
+
+        RegisterSingletonService(container, TestA);
+        RegisterTransientService(container, TestB, FROM_DI(TestA));
+        RegisterScopedService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+        container.template RegisterValue<Config>(Config { 8080, true });
+
+        TestA& a = container.template GetRequiredServiceRef<TestA>();
+        assert(&a == container.template GetRequiredService<TestA>().get());
+        assert(&a == &container.template GetRequiredServiceRef<TestA>());
+
+        Config& configRef = container.template GetRequiredServiceRef<Config>();
+        assert(configRef.port == 8080 && configRef.isVerbose);
+
+        config = container.template GetRequiredService<Config>();
+        assert(config.get() == &configRef);
+
+        auto scope = container.CreateScope();
+        TestC& c = scope.template GetRequiredServiceRef<TestC>();
+        assert(&c == scope.template GetRequiredService<TestC>().get());
+        assert(&scope.template GetRequiredServiceRef<TestA>() == &a);
+
+        bool isThrown = false;
+
+        try
+        {
+            container.template GetRequiredServiceRef<TestB>();
+        }
+        catch (const exc::ServiceNotBorrowableException&)
+        {
+            isThrown = true;
+        }
+
+        assert(isThrown);
+
+        std::vector<std::thread> threads;
+
+        for (int i = 0; i < 8; i++)
+            threads.push_back(std::thread([&container, &a]() {
+                for (int j = 0; j < 100; j++)
+                    assert(&container.template GetRequiredServiceRef<TestA>() == &a);
+            }));
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // The value shares the ownership of its registration
+    assert(config->port == 8080);
+}
+
+void ItWarmsUpSingletons()
+{
+    using namespace test;
+
+    for (int useExecutor = 0; useExecutor < 2; useExecutor++)
+    {
+        std::atomic<int> aCount = 0;
+        std::atomic<int> bCount = 0;
+        std::atomic<int> cCount = 0;
+
+        Container container;
+
+        container.template RegisterSingletonService<TestA>([&aCount](const Container&)
+        {
+            aCount++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return std::make_shared<TestA>();
+        });
+
+        container.template RegisterSingletonService<TestB>([&bCount](const Container& c)
+        {
+            bCount++;
+            return std::make_shared<TestB>(FROM_DI(TestA));
+        });
+
+        container.template RegisterSingletonService<TestC>([&cCount](const Container& c)
+        {
+            cCount++;
+            return std::make_shared<TestC>(FROM_DI(TestA), FROM_DI(TestB));
+        });
+
+        RegisterTransientService(container, TestE, FROM_DI(ITestD));
+
+        if (useExecutor)
+        {
+            std::vector<std::thread> threads;
+
+            container.WarmUp([&threads](std::function<void()> task) { threads.emplace_back(std::move(task)); }, 4);
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+        else
+        {
+            container.WarmUp(4);
+        }
+
+        assert(aCount == 1);
+        assert(bCount == 1);
+        assert(cCount == 1);
+
+        container.template GetRequiredService<TestC>();
+        container.WarmUp();
+
+        assert(aCount == 1);
+        assert(cCount == 1);
+    }
+
+    // Exceptions, thrown by factories, are rethrown
+    Container container;
+
+    container.template RegisterSingletonService<TestA>([](const Container&) -> std::shared_ptr<TestA>
+    {
+        throw std::runtime_error("TestA");
+    });
+
+    bool isThrown = false;
+
+    try
+    {
+        container.WarmUp(2);
+    }
+    catch (const std::runtime_error&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+}
+
+void ItWarmsUpSingletonsInDependencyOrder()
+{
+    struct Leaf1 {};
+    struct Leaf2 {};
+
+    struct Root
+    {
+        Root(std::shared_ptr<Leaf1> leaf1, std::shared_ptr<Leaf2> leaf2) {}
+    };
+
+    Container container;
+
+    // The root is taken first, if the services are taken in registration order
+    container.template RegisterSingletonService<Root>(Inject<Leaf1, Leaf2>());
+
+    std::atomic<int> startedLeafCount = 0;
+    std::atomic<int> overlappedLeafCount = 0;
+
+    // Each leaf waits for the other one, so they are created
+    // concurrently only if no worker waits for the root's dependencies
+    auto waitForOtherLeaf = [&startedLeafCount, &overlappedLeafCount]()
+    {
+        startedLeafCount++;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+        while (startedLeafCount < 2 && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::yield();
+
+        if (startedLeafCount == 2)
+            overlappedLeafCount++;
+    };
+
+    container.template RegisterSingletonService<Leaf1>([&waitForOtherLeaf](const Container&)
+    {
+        waitForOtherLeaf();
+        return std::make_shared<Leaf1>();
+    });
+
+    container.template RegisterSingletonService<Leaf2>([&waitForOtherLeaf](const Container&)
+    {
+        waitForOtherLeaf();
+        return std::make_shared<Leaf2>();
+    });
+
+    container.WarmUp(2);
+
+    assert(overlappedLeafCount == 2);
+    assert(container.template GetRequiredService<Root>() != nullptr);
+}
+
+void ItDetectsCircularDependencyDuringWarmUp()
+{
+    using namespace test;
+    using namespace exc;
+
+    Container container;
+
+    std::atomic<int> startedFactoryCount = 0;
+
+    auto waitForBothFactories = [&startedFactoryCount]()
+    {
+        startedFactoryCount++;
+
+        while (startedFactoryCount < 2)
+            std::this_thread::yield();
+    };
+
+    container.template RegisterSingletonService<CircularDependencyTestClassA>([&](const Container& c)
+    {
+        waitForBothFactories();
+
+        return std::make_shared<CircularDependencyTestClassA>(
+            c.template GetRequiredService<CircularDependencyTestClassB>());
+    });
+
+    container.template RegisterSingletonService<CircularDependencyTestClassB>([&](const Container& c)
+    {
+        waitForBothFactories();
+
+        return std::make_shared<CircularDependencyTestClassB>(
+            c.template GetRequiredService<CircularDependencyTestClassA>());
+    });
+
+    bool isThrown = false;
+
+    try
+    {
+        container.WarmUp(2);
+    }
+    catch (const CircularDependencyException&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+}
+
+void ItPrewarmsServicesFromStartupProfile()
+{
+    using namespace test;
+
+    std::atomic<int> aCount = 0;
+    std::atomic<int> dCount = 0;
+
+    auto registerServices = [&aCount, &dCount](Container& container)
+    {
+        container.template RegisterSingletonService<TestA>([&aCount](const Container&)
+        {
+            aCount++;
+            return std::make_shared<TestA>();
+        });
+
+        container.template RegisterSingletonService<ITestD>([&dCount](const Container&)
+        {
+            dCount++;
+            return std::make_shared<TestD3>();
+        });
+
+        RegisterSingletonService(container, TestB, FROM_DI(TestA));
+        RegisterTransientService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+        RegisterSharedService(container, SameInstanceTestClass);
+    };
+
+    std::stringstream profileFile;
+
+    {
+        Container container;
+        registerServices(container);
+
+        container.StartRecording(std::chrono::minutes(1));
+
+        container.template GetRequiredService<TestC>();
+        container.CreateScope().template GetRequiredService<SameInstanceTestClass>();
+
+        auto profile = container.GetStartupProfile();
+
+        // Transient services are not recorded
+        assert(profile.Entries().size() == 3);
+        assert(profile.Entries()[0].serviceType == typeid(TestA).name());
+        assert(profile.Entries()[1].serviceType == typeid(TestB).name());
+        assert(profile.Entries()[2].lifetime == ServiceLifetime::Shared);
+
+        profile.Save(profileFile);
+    }
+
+    {
+        // The recording stops once the window is over,
+        // even if no services are created after it
+        Container container;
+        container.StartRecording(std::chrono::milliseconds(1));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        assert(!container.GetStartupRecorder()->IsRecording());
+    }
+
+    auto profile = StartupProfile::Load(profileFile);
+    assert(profile.Entries().size() == 3);
+
+    aCount = 0;
+    dCount = 0;
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+    registerServices(container);
+
+    container.Prewarm(profile, 2).get();
+
+    assert(aCount == 1);
+    assert(dCount == 0);
+
+    // The prewarmed shared instance is kept until it's resolved
+    assert(SameInstanceTestClass().Id() == 1);
+    assert(container.template GetRequiredService<SameInstanceTestClass>()->Id() == 0);
+
+    bool isThrown = false;
+
+    try
+    {
+        std::stringstream invalidFile("not a profile");
+        StartupProfile::Load(invalidFile);
+    }
+    catch (const std::runtime_error&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+}
+
+void ItExecutesResolutionPlansInFrozenContainer()
+{
+    using namespace test;
+
+    Container container;
+
+    container.template RegisterSingletonService<TestA>(Inject<>());
+    container.template RegisterTransientService<TestB>(Inject<TestA>());
+    container.template RegisterTransientService<TestC>(Inject<TestA, TestB>());
+    container.template RegisterTransientService<ITestD, TestD>(Inject<TestC>());
+    container.template RegisterTransientService<TestE>(Inject<ITestD>());
+    container.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(1));
+    container.template RegisterTransientService<DependencyHolderTestClass>(Inject<SameInstanceTestClass>());
+
+    // The dependency is not registered, so the plan is not compiled
+    container.template RegisterTransientService<CircularDependencyTestClassA>(Inject<CircularDependencyTestClassB>());
+
+    container.Freeze();
+
+    assert(container.template GetRequiredService<TestE>() != nullptr);
+
+    bool isThrown = false;
+
+    try
+    {
+        container.template GetRequiredService<CircularDependencyTestClassA>();
+    }
+    catch (const exc::ServiceNotRegisteredException&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+    assert(container.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 1);
+
+    // A frozen scope without its own registrations executes the plans
+    auto scope1 = container.CreateScope();
+    scope1.Freeze();
+
+    assert(scope1.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 1);
+
+    // Own registrations of a scope take precedence over the plans
+    auto scope2 = container.CreateScope();
+    scope2.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(2));
+
+    assert(scope2.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 2);
+
+    scope2.Freeze();
+
+    assert(scope2.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 2);
+
+    {
+        // Scopes, frozen before their parent, compile plans for their own registrations
+        Container parent;
+
+        parent.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(1));
+        parent.template RegisterTransientService<DependencyHolderTestClass>(Inject<SameInstanceTestClass>());
+
+        {
+            auto scope = parent.CreateScope();
+            scope.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(2));
+            scope.Freeze();
+
+            assert(scope.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 2);
+        }
+
+        parent.Freeze();
+
+        assert(parent.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 1);
+
+        auto scope = parent.CreateScope();
+        scope.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(3));
+        scope.Freeze();
+
+        assert(scope.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 3);
+        assert(parent.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 1);
+    }
+}
+
+void ItDoesNotLeakCircularResolutionPlans()
+{
+    struct Leaf {};
+
+    struct Node
+    {
+        Node(std::shared_ptr<Node> node, std::shared_ptr<Leaf> leaf) {}
+    };
+
+    auto token = std::make_shared<int>();
+
+    {
+        Container container;
+
+        container.template RegisterSingletonService<Node>(Inject<Node, Leaf>());
+        container.template RegisterSingletonService<Leaf>([token](const Container&)
+        {
+            return std::make_shared<Leaf>();
+        });
+
+        container.Freeze();
+    }
+
+    assert(token.use_count() == 1);
+}
+
+void ItResolvesServicesThroughHandles()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterTransientService(container, TestB, FROM_DI(TestA));
+    RegisterScopedService(container, SameInstanceTestClass);
+
+    auto aHandle = container.template GetHandle<TestA>();
+    auto bHandle = container.template GetHandle<TestB>();
+    auto scopedHandle = container.template GetHandle<SameInstanceTestClass>();
+
+    assert(aHandle.Get(container) == container.template GetRequiredService<TestA>());
+    assert(bHandle.Get(container) != bHandle.Get(container));
+
+    auto scope1 = container.CreateScope();
+    auto scope2 = container.CreateScope();
+
+    auto instance1 = scopedHandle.Get(scope1);
+
+    assert(instance1 == scope1.template GetRequiredService<SameInstanceTestClass>());
+    assert(instance1 == scopedHandle.Get(scope1));
+    assert(instance1 != scopedHandle.Get(scope2));
+    assert(aHandle.Get(scope1) == container.template GetRequiredService<TestA>());
+
+    // Scoped services aren't resolvable from the root container
+    bool isThrown = false;
+
+    try
+    {
+        scopedHandle.Get(container);
+    }
+    catch (const exc::ServiceNotRegisteredException&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+
+    // A scope of a scope resolves the handle by lookup
+    auto scope1_1 = scope1.CreateScope();
+    assert(scopedHandle.Get(scope1_1) == instance1);
+
+    // A handle, taken from a scope, is bound to the scoped registration
+    auto scopeHandle = scope2.template GetHandle<SameInstanceTestClass>();
+    assert(scopeHandle.Get(scope1) == instance1);
+
+    isThrown = false;
+
+    try
+    {
+        container.template GetHandle<TestC>();
+    }
+    catch (const exc::ServiceNotRegisteredException&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+}
+
+void ItAcceptsMoveOnlyFactories()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+
+    auto id = std::make_unique<int>(5);
+
+    container.template RegisterSingletonService<SameInstanceTestClass>(
+        [id = std::move(id)](const Container& c)
+        {
+            return std::make_shared<SameInstanceTestClass>(*id);
+        }
+    );
+
+    auto scopedId = std::make_unique<int>(7);
+
+    container.template RegisterScopedService<TestA>(
+        [scopedId = std::move(scopedId)](const Container& c)
+        {
+            assert(*scopedId == 7);
+            return std::make_shared<TestA>();
+        }
+    );
+
+    assert(container.template GetRequiredService<SameInstanceTestClass>()->Id() == 5);
+
+    auto scope1 = container.CreateScope();
+    auto scope2 = container.CreateScope();
+
+    assert(scope1.template GetRequiredService<TestA>() != scope2.template GetRequiredService<TestA>());
+}
+
+void ItAllocatesServicesFromScopeArena()
+{
+    using namespace test;
+
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        int AllocationCount = 0;
+
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            AllocationCount++;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    CountingResource upstream;
+    auto previousResource = std::pmr::set_default_resource(&upstream);
+
+    {
+        Container container;
+        container.template RegisterScopedService<TestA>(ARENA_FACTORY(TestA));
+        container.template RegisterTransientService<TestB>(ARENA_FACTORY(TestB, FROM_DI(TestA)));
+
+        assert(container.GetMemoryResource() == &upstream);
+
+        auto scope = container.CreateScope();
+        assert(scope.GetMemoryResource() != &upstream);
+        assert(upstream.AllocationCount == 0);
+
+        auto a = scope.template GetRequiredService<TestA>();
+        auto b1 = scope.template GetRequiredService<TestB>();
+        auto b2 = scope.template GetRequiredService<TestB>();
+
+        assert(a == scope.template GetRequiredService<TestA>());
+        assert(b1 != b2);
+        assert(upstream.AllocationCount == 1);
+    }
+
+    // Scoped services, registered with Inject, are allocated from the arena on request
+    {
+        Container container;
+        container.template RegisterScopedService<TestA>(Inject<>(), true);
+
+        auto scope = container.CreateScope();
+        upstream.AllocationCount = 0;
+
+        auto a = scope.template GetRequiredService<TestA>();
+
+        assert(a != nullptr);
+        assert(upstream.AllocationCount == 1);
+    }
+
+    // Otherwise they are not
+    {
+        Container container;
+        container.template RegisterScopedService<TestA>(Inject<>());
+
+        auto scope = container.CreateScope();
+        upstream.AllocationCount = 0;
+
+        auto a = scope.template GetRequiredService<TestA>();
+
+        assert(a != nullptr);
+        assert(upstream.AllocationCount == 0);
+    }
+
+    std::pmr::set_default_resource(previousResource);
+}
+
+void ItKeepsInjectedScopedServicesAfterScopeDestruction()
+{
+    using namespace test;
+
+    Container container;
+
+    container.template RegisterSingletonService<SameInstanceTestClass>(FACTORY(SameInstanceTestClass, 7));
+    container.template RegisterScopedService<DependencyHolderTestClass>(Inject<SameInstanceTestClass>());
+
+    std::shared_ptr<DependencyHolderTestClass> holder;
+
+    {
+        auto scope = container.CreateScope();
+        holder = scope.template GetRequiredService<DependencyHolderTestClass>();
+    }
+
+    assert(holder->Dependency()->Id() == 7);
+}
+
+void ItReusesPooledScopes()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+    RegisterScopedService(container, SameInstanceTestClass);
+
+    ScopePool pool(container, 1);
+
+    Container* firstScope = nullptr;
+    std::weak_ptr<SameInstanceTestClass> firstInstance;
+
+    {
+        auto scope = pool.Acquire();
+        firstScope = &*scope;
+
+        auto instance = scope->template GetRequiredService<SameInstanceTestClass>();
+        firstInstance = instance;
+
+        RegisterSingletonService(*scope, TestA);
+        assert(scope->template GetService<TestA>() != nullptr);
+        assert(scope->IsScope());
+    }
+
+    assert(firstInstance.expired());
+
+    RegisterSingletonService(container, TestD3);
+
+    {
+        auto scope = pool.Acquire();
+        assert(&*scope == firstScope);
+
+        auto instance = scope->template GetRequiredService<SameInstanceTestClass>();
+
+        assert(instance->Id() == 1);
+        assert(scope->template GetService<TestA>() == nullptr);
+        assert(scope->template GetService<TestD3>() != nullptr);
+
+        auto otherScope = pool.Acquire();
+        assert(&*otherScope != firstScope);
+        assert(otherScope->template GetRequiredService<SameInstanceTestClass>()->Id() == 2);
+    }
+}
+
+void ItHandlesMultithreadedAccessToScopePoolCorrectly()
+{
+    using namespace test;
+
+    Container container;
+
+    RegisterSingletonService(container, TestA);
+    RegisterScopedService(container, TestB, FROM_DI(TestA));
+
+    ScopePool pool(container, 4);
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; i++)
+        threads.push_back(std::thread([&]() {
+            for (int j = 0; j < 100; j++)
+            {
+                auto scope = pool.Acquire();
+
+                auto b1 = scope->template GetRequiredService<TestB>();
+                auto b2 = scope->template GetRequiredService<TestB>();
+
+                assert(b1 != nullptr);
+                assert(b1 == b2);
+            }
+        }));
+
+    for (auto& thread : threads)
+        if (thread.joinable())
+            thread.join();
+}
+
+void ItIsolatesScopeAndParentRegistrations()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+    RegisterSingletonService(container, SameInstanceTestClass, 1);
+
+    auto scope = container.CreateScope();
+
+    RegisterSingletonService(container, SameInstanceTestClass, 2);
+    RegisterSingletonService(scope, SameInstanceTestClass, 3);
+
+    auto containerInstances = container.template GetServices<SameInstanceTestClass>();
+    auto scopeInstances = scope.template GetServices<SameInstanceTestClass>();
+
+    assert(containerInstances.size() == 2);
+    assert(containerInstances[0]->Id() == 1);
+    assert(containerInstances[1]->Id() == 2);
+
+    assert(scopeInstances.size() == 2);
+    assert(scopeInstances[0]->Id() == 1);
+    assert(scopeInstances[1]->Id() == 3);
+
+    assert(containerInstances[0] == scopeInstances[0]);
+    assert(scope.template GetRequiredService<SameInstanceTestClass>()->Id() == 3);
+}
+
+void ItReturnsMultipleRegisteredServices()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+
+    RegisterSingletonService(container, SameInstanceTestClass, 1);
+    RegisterSingletonService(container, SameInstanceTestClass, 2);
+    RegisterSingletonService(container, SameInstanceTestClass, 3);
+
+    auto instances = container.template GetServices<SameInstanceTestClass>();
+
+    assert(instances[0]->Id() == 1);
+    assert(instances[1]->Id() == 2);
+    assert(instances[2]->Id() == 3);
+}
+
+void ItReturnsLastRegisteredService()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+
+    RegisterSingletonService(container, SameInstanceTestClass, 1);
+    RegisterSingletonService(container, SameInstanceTestClass, 2);
+    RegisterSingletonService(container, SameInstanceTestClass, 3);
+
+    auto service = container.template GetRequiredService<SameInstanceTestClass>();
+
+    assert(service->Id() == 3);
+}
+
+void ItResolvesServicesRegisteredByTypeIndex()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+
+    container.RegisterService(
+        std::type_index(typeid(SameInstanceTestClass)),
+        std::make_shared<impl::SingletonService<DefaultThreadingPolicy, SameInstanceTestClass>>(
+            FACTORY(SameInstanceTestClass, 42)
+        )
+    );
+
+    auto instance = container.template GetRequiredService<SameInstanceTestClass>();
+
+    assert(instance->Id() == 42);
+    assert(impl::GetTypeId<SameInstanceTestClass>() == impl::GetTypeId(typeid(SameInstanceTestClass)));
 }
 
 void ItHandlesMultithreadedAccessCorrectly()
@@ -270,7 +1688,7 @@ void ItHandlesMultithreadedAccessCorrectly()
             }
         }));
 
-    for (int i = 0; i < threads.size(); i++)
+    for (std::size_t i = 0; i < threads.size(); i++)
         if (threads[i].joinable())
             threads[i].join();
 }
@@ -345,9 +1763,40 @@ void RunTests()
     ItReturnsSameSharedInstanceWhileItIsAlive();
     ItReturnsCorrectScopedServiceInstance();
     ItAllowsCreatingScopeOfAScope();
+    ItCreatesSingleThreadedScopes();
+    ItSupportsThreadingPolicies();
+    ItRequiresLockFreeFrozenContainersToBeFrozenBeforeSharing();
+    ItBuildsScopedServicesOnFirstResolution();
+    ItResolvesServicesThroughHandles();
+    ItResolvesMultipleServicesAtOnce();
+    ItAcceptsMoveOnlyFactories();
+    ItInjectsConstructorDependencies();
+    ItExecutesResolutionPlansInFrozenContainer();
+    ItDoesNotLeakCircularResolutionPlans();
+    ItResolvesNestedServicesThroughResolutionContext();
+    ItCachesResolvedServicesPerThread();
+    ItResolvesServicesByReference();
+    ItWarmsUpSingletons();
+    ItPrewarmsServicesFromStartupProfile();
+    ItAllocatesServicesFromScopeArena();
+    ItKeepsInjectedScopedServicesAfterScopeDestruction();
+    ItReusesPooledScopes();
+    ItIsolatesScopeAndParentRegistrations();
     ItReturnsMultipleRegisteredServices();
+    ItIteratesOverMultipleServicesWithoutAllocating();
     ItReturnsLastRegisteredService();
     ItDetectsCircularDependency();
+    ItResolvesServicesRegisteredByTypeIndex();
+    ItRejectsRegistrationInFrozenContainer();
+    ItRecoversFromThrowingFactory();
 
+#ifndef SOLINJECT_NOTHREADSAFE
     ItHandlesMultithreadedAccessCorrectly();
+    ItHandlesMultithreadedAccessToFrozenContainerCorrectly();
+    ItHandlesMultithreadedAccessToScopePoolCorrectly();
+    ItDoesNotBlockOtherServicesWhileSingletonIsBeingCreated();
+    ItDetectsCircularDependencyBetweenThreads();
+    ItWarmsUpSingletonsInDependencyOrder();
+    ItDetectsCircularDependencyDuringWarmUp();
+#endif
 }
@@ -0,0 +1,182 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#define SOLINJECT_INLINE_CACHE
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <assert.h>
+#include <solinject.hpp>
+#include <solinject-macros.hpp>
+
+#include "TestClasses.hpp"
+
+using namespace sol::di;
+
+void RunTests();
+
+int main()
+{
+    try
+    {
+        RunTests();
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+    }
+
+    return -1;
+}
+
+// The macros are expanded once, so all the containers share the inline caches
+void RegisterHolder(Container& container)
+{
+    using namespace test;
+
+    RegisterTransientService(container, DependencyHolderTestClass, FROM_DI(SameInstanceTestClass));
+}
+
+void RegisterOptionalHolder(Container& container)
+{
+    using namespace test;
+
+    RegisterTransientService(container, DependencyHolderTestClass, FROM_DI_OPTIONAL(SameInstanceTestClass));
+}
+
+void ItResolvesCachedServicesFromSeveralContainers()
+{
+    using namespace test;
+
+    Container container1;
+    Container container2;
+
+    container1.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(1));
+    container2.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(2));
+
+    RegisterHolder(container1);
+    RegisterHolder(container2);
+
+    for (int i = 0; i < 3; i++)
+    {
+        assert(container1.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 1);
+        assert(container2.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 2);
+    }
+
+    // Registering a service invalidates the cache
+    container1.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(3));
+    assert(container1.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 3);
+
+    container1.Freeze();
+    assert(container1.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 3);
+    assert(container2.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 2);
+}
+
+void ItRespectsLifetimesOfCachedServices()
+{
+    using namespace test;
+
+    SameInstanceTestClass::ResetIds();
+
+    Container container;
+    RegisterScopedService(container, SameInstanceTestClass);
+    RegisterHolder(container);
+
+    auto scope1 = container.CreateScope();
+    auto scope2 = container.CreateScope();
+
+    auto id1 = scope1.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id();
+    auto id2 = scope2.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id();
+
+    assert(id1 != id2);
+    assert(scope1.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == id1);
+    assert(scope2.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == id2);
+
+    Container transientContainer;
+    RegisterTransientService(transientContainer, SameInstanceTestClass);
+    RegisterHolder(transientContainer);
+
+    auto transientId = transientContainer.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id();
+    assert(transientContainer.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() != transientId);
+}
+
+void ItCachesMissingOptionalServices()
+{
+    using namespace test;
+
+    Container container;
+    RegisterOptionalHolder(container);
+
+    assert(container.template GetRequiredService<DependencyHolderTestClass>()->Dependency() == nullptr);
+    assert(container.template GetRequiredService<DependencyHolderTestClass>()->Dependency() == nullptr);
+
+    container.template RegisterSingletonService<SameInstanceTestClass>(std::make_shared<SameInstanceTestClass>(1));
+    assert(container.template GetRequiredService<DependencyHolderTestClass>()->Dependency()->Id() == 1);
+
+    bool isThrown = false;
+    Container emptyContainer;
+    RegisterHolder(emptyContainer);
+
+    try
+    {
+        emptyContainer.template GetRequiredService<DependencyHolderTestClass>();
+    }
+    catch (const exc::ServiceNotRegisteredException&)
+    {
+        isThrown = true;
+    }
+
+    assert(isThrown);
+}
+
+void ItHandlesMultithreadedAccessToCachedServicesCorrectly()
+{
+    using namespace test;
+
+    Container container;
+    RegisterSingletonService(container, SameInstanceTestClass);
+    RegisterHolder(container);
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < 8; i++)
+        threads.push_back(std::thread([&container, i]() {
+            for (int j = 0; j < 100; j++)
+            {
+                if (i == 0 && j % 10 == 0)
+                    RegisterSingletonService(container, SameInstanceTestClass);
+
+                assert(container.template GetRequiredService<DependencyHolderTestClass>()->Dependency() != nullptr);
+            }
+        }));
+
+    for (auto& thread : threads)
+        thread.join();
+}
+
+void RunTests()
+{
+    ItResolvesCachedServicesFromSeveralContainers();
+    ItRespectsLifetimesOfCachedServices();
+    ItCachesMissingOptionalServices();
+    ItHandlesMultithreadedAccessToCachedServicesCorrectly();
+}
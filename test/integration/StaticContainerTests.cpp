@@ -0,0 +1,123 @@
+﻿// SPDX-License-Identifier: LGPL-3.0-or-later
+
+/*
+ * solinject - C++ Dependency Injection header-only library
+ * Copyright (C) 2022  SemperSolus0x3d
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <assert.h>
+#include <solinject.hpp>
+#include <solinject-macros.hpp>
+
+#include "TestClasses.hpp"
+
+using namespace sol::di;
+
+void RunTests();
+
+int main()
+{
+    try
+    {
+        RunTests();
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cout << ex.what() << std::endl;
+    }
+
+    return -1;
+}
+
+void ItResolvesStaticServices()
+{
+    using namespace test;
+
+    StaticContainer<
+        StaticSingleton<TestA, TestA>,
+        StaticTransient<TestB, TestB, TestA>,
+        StaticShared<TestC, TestC, TestA, TestB>,
+        StaticSingleton<ITestD, TestD, TestC>
+    > container;
+
+    static_assert(decltype(container)::IsRegistered<TestA>());
+    static_assert(!decltype(container)::IsRegistered<TestD>());
+
+    auto a = container.template GetRequiredService<TestA>();
+    assert(a != nullptr);
+    assert(a == container.template GetRequiredService<TestA>());
+
+    auto b = container.template GetRequiredService<TestB>();
+    assert(b != nullptr);
+    assert(b != container.template GetRequiredService<TestB>());
+
+    auto c = container.template GetRequiredService<TestC>();
+    assert(c == container.template GetRequiredService<TestC>());
+
+    assert(container.template GetRequiredService<ITestD>() != nullptr);
+}
+
+void ItReturnsLastStaticRegistration()
+{
+    using namespace test;
+
+    StaticContainer<
+        StaticSingleton<ITestD, TestD3>,
+        StaticSingleton<TestA, TestA>,
+        StaticSingleton<TestB, TestB, TestA>,
+        StaticSingleton<ITestD, TestD2, TestB>
+    > container;
+
+    auto d = container.template GetRequiredService<ITestD>();
+
+    assert(dynamic_cast<TestD2*>(d.get()) != nullptr);
+}
+
+void ItExportsStaticServicesToContainer()
+{
+    using namespace test;
+
+    StaticContainer<
+        StaticSingleton<TestA, TestA>,
+        StaticShared<TestB, TestB, TestA>,
+        StaticTransient<ITestD, TestD3>
+    > staticContainer;
+
+    Container container;
+    staticContainer.ExportTo(container);
+
+    RegisterTransientService(container, TestC, FROM_DI(TestA), FROM_DI(TestB));
+
+    assert(container.template GetRequiredService<TestA>() == staticContainer.template GetRequiredService<TestA>());
+    assert(container.template GetRequiredService<TestC>() != nullptr);
+
+    auto b = staticContainer.template GetRequiredService<TestB>();
+    assert(container.template GetRequiredService<TestB>() == b);
+
+    auto d = container.template GetRequiredService<ITestD>();
+    assert(d != container.template GetRequiredService<ITestD>());
+}
+
+void RunTests()
+{
+    ItResolvesStaticServices();
+    ItReturnsLastStaticRegistration();
+    ItExportsStaticServicesToContainer();
+}